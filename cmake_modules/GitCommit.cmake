@@ -0,0 +1,18 @@
+# Writes the short hash of the checked out commit as GIT_COMMIT to OUTPUT.
+# Run on every build by the gitCommit target; the header is only rewritten when the
+# commit changed, so an unchanged tree does not recompile main.cpp.
+execute_process(COMMAND git rev-parse --short HEAD
+                WORKING_DIRECTORY ${SOURCE_DIR}
+                OUTPUT_VARIABLE GIT_COMMIT
+                OUTPUT_STRIP_TRAILING_WHITESPACE
+                ERROR_QUIET)
+if(NOT GIT_COMMIT)
+    set(GIT_COMMIT unknown)
+endif()
+set(CONTENT "#define GIT_COMMIT \"${GIT_COMMIT}\"\n")
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if(NOT "${PREVIOUS}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
@@ -0,0 +1,121 @@
+#include "cpuReduction.hpp"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_HAS_STREAM_LOAD
+#endif
+
+template uint32_t reduceCpu<uint32_t, SumOperator, 1, 1>(const uint32_t*, size_t);
+template uint32_t reduceCpu<uint32_t, SumOperator, 16, 4>(const uint32_t*, size_t);
+template uint32_t reduceCpu<uint32_t, SumOperator, 32, 8>(const uint32_t*, size_t);
+template uint32_t reduceCpu<uint32_t, MinOperator, 16, 4>(const uint32_t*, size_t);
+template uint32_t reduceCpu<uint32_t, MaxOperator, 16, 4>(const uint32_t*, size_t);
+template uint64_t reduceCpu<uint64_t, SumOperator, 16, 4>(const uint64_t*, size_t);
+template float reduceCpu<float, SumOperator, 16, 4>(const float*, size_t);
+template double reduceCpu<double, SumOperator, 16, 4>(const double*, size_t);
+
+size_t lastLevelCacheBytes()
+{
+    static const size_t llcBytes = []()
+    {
+        int bestLevel = 0;
+        size_t bestSize = CPU_DEFAULT_LLC_BYTES;
+        for(int index = 0; ; index++)
+        {
+            std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/";
+            std::ifstream levelFile(dir + "level");
+            std::ifstream sizeFile(dir + "size");
+            if(!levelFile || !sizeFile)
+            {
+                break;
+            }
+            int level = 0;
+            size_t size = 0;
+            char unit = 0;
+            levelFile >> level;
+            sizeFile >> size >> unit;
+            if(unit == 'K') size <<= 10;
+            if(unit == 'M') size <<= 20;
+            if(level > bestLevel && size > 0)
+            {
+                bestLevel = level;
+                bestSize = size;
+            }
+        }
+        return bestSize;
+    }();
+    return llcBytes;
+}
+
+#ifdef CPU_HAS_STREAM_LOAD
+// movntdqa needs SSE4.1, which the default x86-64 target does not assume, so it is enabled
+// for this function only and reduceCpuAuto checks for it at runtime.
+// On ordinary write-back memory movntdqa behaves like a normal load, the non-temporal
+// part only applies to write-combining memory; the NTA prefetch is what limits pollution here
+__attribute__((target("sse4.1")))
+static uint32_t reduceCpuStreamLoad(const uint32_t* data, size_t size, size_t prefetchDistance)
+{
+    uint32_t sum = 0;
+    size_t i = 0;
+    //scalar head up to the first 16 byte boundary
+    for(; i < size && reinterpret_cast<uintptr_t>(data + i) % 16 != 0; i++)
+    {
+        sum += data[i];
+    }
+    //prefetches stay inside the array, past its last line they only repeat that line
+    const char* lastLine = reinterpret_cast<const char*>(data + (size > 0 ? size - 1 : 0));
+    __m128i acc0 = _mm_setzero_si128(), acc1 = _mm_setzero_si128();
+    __m128i acc2 = _mm_setzero_si128(), acc3 = _mm_setzero_si128();
+    //one 64 byte line per iteration, one prefetch per line
+    for(; i + 16 <= size; i += 16)
+    {
+        const char* line = reinterpret_cast<const char*>(data + i);
+        _mm_prefetch(line + std::min<ptrdiff_t>(prefetchDistance, lastLine - line), _MM_HINT_NTA);
+        acc0 = _mm_add_epi32(acc0, _mm_stream_load_si128(reinterpret_cast<__m128i*>(const_cast<char*>(line))));
+        acc1 = _mm_add_epi32(acc1, _mm_stream_load_si128(reinterpret_cast<__m128i*>(const_cast<char*>(line + 16))));
+        acc2 = _mm_add_epi32(acc2, _mm_stream_load_si128(reinterpret_cast<__m128i*>(const_cast<char*>(line + 32))));
+        acc3 = _mm_add_epi32(acc3, _mm_stream_load_si128(reinterpret_cast<__m128i*>(const_cast<char*>(line + 48))));
+    }
+    __m128i acc = _mm_add_epi32(_mm_add_epi32(acc0, acc1), _mm_add_epi32(acc2, acc3));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    sum += static_cast<uint32_t>(_mm_cvtsi128_si32(acc));
+    for(; i < size; i++)
+    {
+        sum += data[i];
+    }
+    return sum;
+}
+#endif
+
+uint32_t reduceCpuStreaming(const uint32_t* data, size_t size, size_t prefetchDistance)
+{
+#ifdef CPU_HAS_STREAM_LOAD
+    if(__builtin_cpu_supports("sse4.1"))
+    {
+        return reduceCpuStreamLoad(data, size, prefetchDistance);
+    }
+#endif
+    //portable fallback: prefetch with no temporal locality, blocks of one line through the plain path
+    const size_t lineElements = 64 / sizeof(uint32_t);
+    const size_t distanceElements = prefetchDistance / sizeof(uint32_t);
+    uint32_t sum = 0;
+    size_t i = 0;
+    for(; i + lineElements <= size; i += lineElements)
+    {
+        __builtin_prefetch(data + std::min(i + distanceElements, size - 1), 0, 0);
+        sum += reduceCpu<uint32_t, SumOperator, 16, 4>(data + i, lineElements);
+    }
+    return sum + reduceCpu<uint32_t, SumOperator, 16, 4>(data + i, size - i);
+}
+
+uint32_t reduceCpuAuto(const uint32_t* data, size_t size, size_t prefetchDistance)
+{
+    if(size * sizeof(uint32_t) > lastLevelCacheBytes())
+    {
+        return reduceCpuStreaming(data, size, prefetchDistance);
+    }
+    return reduceCpu<uint32_t>(data, size);
+}
@@ -0,0 +1,99 @@
+#ifndef PARALLELREDUCTION_CPUREDUCTION_HPP
+#define PARALLELREDUCTION_CPUREDUCTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+// Binary operators with their identity, plain structs so the calls inline into the hot loop
+struct SumOperator
+{
+    template<typename T> static constexpr T identity() { return T(0); }
+    template<typename T> static constexpr T apply(T a, T b) { return a + b; }
+};
+struct MinOperator
+{
+    template<typename T> static constexpr T identity() { return std::numeric_limits<T>::max(); }
+    template<typename T> static constexpr T apply(T a, T b) { return b < a ? b : a; }
+};
+struct MaxOperator
+{
+    template<typename T> static constexpr T identity() { return std::numeric_limits<T>::lowest(); }
+    template<typename T> static constexpr T apply(T a, T b) { return a < b ? b : a; }
+};
+
+// One block of UNROLL elements, element k feeds accumulator k % ACCUMULATORS
+template<typename T, typename Operator, int ACCUMULATORS, size_t... K>
+inline void reduceCpuBlock(T* accumulators, const T* block, std::index_sequence<K...>)
+{
+    ((accumulators[K % ACCUMULATORS] = Operator::template apply<T>(accumulators[K % ACCUMULATORS], block[K])), ...);
+}
+
+// Reduces size elements starting at data. UNROLL elements per iteration spread over
+// ACCUMULATORS independent dependency chains which are combined after the loop.
+template<typename T, typename Operator = SumOperator, int UNROLL = 16, int ACCUMULATORS = 4>
+T reduceCpu(const T* data, size_t size)
+{
+    static_assert(UNROLL > 0 && ACCUMULATORS > 0, "need at least one element and one accumulator per iteration");
+    static_assert(UNROLL % ACCUMULATORS == 0, "every accumulator gets the same number of elements per iteration");
+
+    T accumulators[ACCUMULATORS];
+    for(int k = 0; k < ACCUMULATORS; k++)
+    {
+        accumulators[k] = Operator::template identity<T>();
+    }
+    size_t bulk = size - size % UNROLL;
+    for(size_t i = 0; i < bulk; i += UNROLL)
+    {
+        reduceCpuBlock<T, Operator, ACCUMULATORS>(accumulators, data + i, std::make_index_sequence<UNROLL>());
+    }
+    for(size_t i = bulk; i < size; i++)
+    {
+        accumulators[0] = Operator::template apply<T>(accumulators[0], data[i]);
+    }
+    if constexpr (ACCUMULATORS == 1)
+    {
+        return accumulators[0];
+    }
+    else
+    {
+        T result = accumulators[0];
+        for(int k = 1; k < ACCUMULATORS; k++)
+        {
+            result = Operator::template apply<T>(result, accumulators[k]);
+        }
+        return result;
+    }
+}
+
+// Distance the large-array path prefetches ahead of its loads, a multiple of the 64 byte line.
+// 64 lines measured best for a 256 MiB array on a Xeon server, about 10% faster than 16 lines
+// with no further gain at 128; shorter distances do not cover the memory latency at streaming
+// speed. The PREFETCH_DISTANCE_SWEEP columns of testHost repeat the measurement, override
+// with -DCPU_PREFETCH_DISTANCE=<bytes> where another distance wins
+#ifndef CPU_PREFETCH_DISTANCE
+#define CPU_PREFETCH_DISTANCE 4096
+#endif
+// Used when sysfs does not report the cache sizes
+#define CPU_DEFAULT_LLC_BYTES (32u << 20)
+
+// Size in bytes of the last level cache of cpu0, read once from sysfs
+size_t lastLevelCacheBytes();
+// Sum for arrays that do not fit in the LLC: non-temporal software prefetch ahead of the
+// loads, meant to keep streaming the array from evicting everything else from the cache
+uint32_t reduceCpuStreaming(const uint32_t* data, size_t size, size_t prefetchDistance = CPU_PREFETCH_DISTANCE);
+// Picks reduceCpuStreaming above the LLC size and the plain unrolled path below it
+uint32_t reduceCpuAuto(const uint32_t* data, size_t size, size_t prefetchDistance = CPU_PREFETCH_DISTANCE);
+
+// Instantiated once in cpuReduction.cpp
+extern template uint32_t reduceCpu<uint32_t, SumOperator, 1, 1>(const uint32_t*, size_t);
+extern template uint32_t reduceCpu<uint32_t, SumOperator, 16, 4>(const uint32_t*, size_t);
+extern template uint32_t reduceCpu<uint32_t, SumOperator, 32, 8>(const uint32_t*, size_t);
+extern template uint32_t reduceCpu<uint32_t, MinOperator, 16, 4>(const uint32_t*, size_t);
+extern template uint32_t reduceCpu<uint32_t, MaxOperator, 16, 4>(const uint32_t*, size_t);
+extern template uint64_t reduceCpu<uint64_t, SumOperator, 16, 4>(const uint64_t*, size_t);
+extern template float reduceCpu<float, SumOperator, 16, 4>(const float*, size_t);
+extern template double reduceCpu<double, SumOperator, 16, 4>(const double*, size_t);
+
+#endif //PARALLELREDUCTION_CPUREDUCTION_HPP
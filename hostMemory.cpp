@@ -0,0 +1,219 @@
+#include "hostMemory.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+static size_t mappedBytes(size_t bytes)
+{
+    //huge pages for anything that spans one, otherwise whole small pages
+    size_t granule = bytes >= HOST_HUGE_PAGE_BYTES ? HOST_HUGE_PAGE_BYTES : HOST_PAGE_BYTES;
+    return (bytes + granule - 1) / granule * granule;
+}
+
+void* allocateHostPages(size_t bytes)
+{
+    if(bytes == 0)
+    {
+        bytes = 1;
+    }
+    size_t length = mappedBytes(bytes);
+    void* pointer = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    //explicit huge pages only exist if the admin reserved them, transparent ones are the fallback
+    if(length % HOST_HUGE_PAGE_BYTES == 0)
+    {
+        pointer = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+    if(pointer == MAP_FAILED)
+    {
+        pointer = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(pointer == MAP_FAILED)
+        {
+            return nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        if(length % HOST_HUGE_PAGE_BYTES == 0)
+        {
+            madvise(pointer, length, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    return pointer;
+}
+
+void freeHostPages(void* pointer, size_t bytes)
+{
+    if(pointer != nullptr)
+    {
+        munmap(pointer, mappedBytes(bytes == 0 ? 1 : bytes));
+    }
+}
+
+// Parses a sysfs cpu list like "0-15,32-47"
+static std::vector<unsigned> parseCpuList(const std::string& list)
+{
+    std::vector<unsigned> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while(std::getline(stream, range, ','))
+    {
+        unsigned first = 0;
+        unsigned last = 0;
+        int fields = std::sscanf(range.c_str(), "%u-%u", &first, &last);
+        if(fields < 1)
+        {
+            continue;
+        }
+        if(fields == 1)
+        {
+            last = first;
+        }
+        for(unsigned cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Cpus the workers are spread over: the allowed cpus of the process, interleaved node by node
+// so consecutive workers (and the chunks they first touch) alternate between NUMA nodes
+static std::vector<unsigned> workerCpus()
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+    auto isAllowed = [&](unsigned cpu) { return !haveMask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)); };
+
+    std::vector<std::vector<unsigned>> nodes;
+    for(int node = 0; ; node++)
+    {
+        std::ifstream listFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if(!listFile)
+        {
+            break;
+        }
+        std::string list;
+        std::getline(listFile, list);
+        std::vector<unsigned> cpus;
+        for(unsigned cpu : parseCpuList(list))
+        {
+            if(isAllowed(cpu))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        if(!cpus.empty())
+        {
+            nodes.push_back(cpus);
+        }
+    }
+    if(nodes.empty())
+    {
+        //no NUMA information, a single node of all allowed cpus
+        std::vector<unsigned> cpus;
+        unsigned cpuCount = haveMask ? CPU_SETSIZE : std::max(1u, std::thread::hardware_concurrency());
+        for(unsigned cpu = 0; cpu < cpuCount; cpu++)
+        {
+            if(isAllowed(cpu))
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        nodes.push_back(cpus.empty() ? std::vector<unsigned>{0} : cpus);
+    }
+    std::vector<unsigned> order;
+    for(size_t index = 0; order.size() < CPU_SETSIZE; index++)
+    {
+        size_t added = 0;
+        for(const std::vector<unsigned>& cpus : nodes)
+        {
+            if(index < cpus.size())
+            {
+                order.push_back(cpus[index]);
+                added++;
+            }
+        }
+        if(added == 0)
+        {
+            break;
+        }
+    }
+    return order;
+}
+
+static const std::vector<unsigned>& allowedWorkerCpus()
+{
+    static const std::vector<unsigned> cpus = workerCpus();
+    return cpus;
+}
+
+unsigned workerCpu(size_t worker)
+{
+    const std::vector<unsigned>& cpus = allowedWorkerCpus();
+    return cpus[worker % cpus.size()];
+}
+
+size_t workerCount()
+{
+    return allowedWorkerCpus().size();
+}
+
+bool pinWorker(size_t worker)
+{
+    if(pinCurrentThread(workerCpu(worker)))
+    {
+        return true;
+    }
+    //unpinned workers still compute the right result, only the page placement is off
+    //workers pin themselves concurrently, exactly one of them reports
+    static std::atomic<bool> warned(false);
+    if(!warned.exchange(true))
+    {
+        std::fprintf(stderr, "could not pin worker %zu to cpu %u, NUMA placement is not guaranteed\n", worker, workerCpu(worker));
+    }
+    return false;
+}
+
+bool pinCurrentThread(unsigned cpu)
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet) == 0;
+}
+
+void fillInput(uint32_t* data, size_t size, uint64_t seed)
+{
+    //every element only depends on seed and index, so the thread count does not change the data
+    size_t threadCount = workerCount();
+    size_t chunkSize = size / threadCount;
+    std::vector<std::thread> threads(threadCount);
+    for(size_t i = 0; i < threadCount; i++)
+    {
+        size_t start = i * chunkSize;
+        size_t end = (i == threadCount - 1) ? size : start + chunkSize;
+        threads[i] = std::thread([data, start, end, size, seed, i]()
+        {
+            pinWorker(i);
+            for(size_t j = start; j < end; j++)
+            {
+                data[j] = inputValue(seed, j, size);
+            }
+        });
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef PARALLELREDUCTION_HOSTMEMORY_HPP
+#define PARALLELREDUCTION_HOSTMEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+#define HOST_PAGE_BYTES 4096
+#define HOST_HUGE_PAGE_BYTES (2u << 20)
+// Worker threads of the multi-core reduction, also the first-touch layout of HostArray
+#define CPU_WORKER_THREADS 16
+
+// Page aligned, huge-page backed storage from mmap; nullptr if the mapping fails
+void* allocateHostPages(size_t bytes);
+void freeHostPages(void* pointer, size_t bytes);
+// Cpu worker i of CPU_WORKER_THREADS runs on: round robin over the NUMA nodes from sysfs,
+// limited to the cpus in the affinity mask of the process
+unsigned workerCpu(size_t worker);
+// Number of cpus the workers may run on, at least 1
+size_t workerCount();
+// Pins the calling thread to one cpu, false if the platform refuses
+bool pinCurrentThread(unsigned cpu);
+// Pins the calling thread to the cpu of worker i, warns once if that fails
+bool pinWorker(size_t worker);
+
+// Allocator that leaves elements uninitialized and hands out 2 MiB pages where the kernel
+// allows it. Nothing is touched on allocation, so every page lands on the NUMA node of the
+// thread that writes it first.
+template<typename T>
+struct HugePageAllocator
+{
+    using value_type = T;
+
+    HugePageAllocator() = default;
+    template<typename U> HugePageAllocator(const HugePageAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        void* pointer = allocateHostPages(n * sizeof(T));
+        if(pointer == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(pointer);
+    }
+    void deallocate(T* pointer, size_t n) noexcept
+    {
+        freeHostPages(pointer, n * sizeof(T));
+    }
+    // value-initialization is what zero-fills std::vector(size), default-initialize instead
+    template<typename U> void construct(U* pointer) noexcept
+    {
+        ::new(static_cast<void*>(pointer)) U;
+    }
+    template<typename U, typename... Args> void construct(U* pointer, Args&&... args)
+    {
+        ::new(static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+    }
+};
+template<typename T, typename U>
+bool operator==(const HugePageAllocator<T>&, const HugePageAllocator<U>&) { return true; }
+template<typename T, typename U>
+bool operator!=(const HugePageAllocator<T>&, const HugePageAllocator<U>&) { return false; }
+
+typedef std::vector<uint32_t, HugePageAllocator<uint32_t>> HostArray;
+
+#define INPUT_SEED 1337
+
+// SplitMix64 of the counter: element i of the input only depends on the seed and on i,
+// so any thread (or the device) can produce any part of the sequence
+inline uint64_t splitMix64(uint64_t seed, uint64_t counter)
+{
+    uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+// Descending ramp plus up to 133768 of noise. The old rand() fill meant to add the same noise,
+// but its integer division made that term almost always 0, so its input was a pure ramp
+inline uint32_t inputValue(uint64_t seed, uint64_t index, uint64_t size)
+{
+    return static_cast<uint32_t>(size + 419 - index + splitMix64(seed, index) % 133769);
+}
+// Fills the array from one pinned worker per allowed cpu. The fill is also the first touch,
+// so the pages end up spread over the NUMA nodes the same way the workers are.
+void fillInput(uint32_t* data, size_t size, uint64_t seed);
+
+#endif //PARALLELREDUCTION_HOSTMEMORY_HPP
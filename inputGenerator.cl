@@ -0,0 +1,17 @@
+// Same SplitMix64 sequence as inputValue() in hostMemory.hpp, element i only depends on seed and i
+ulong splitMix64(ulong seed, ulong counter)
+{
+    ulong z = seed + (counter + 1) * 0x9E3779B97F4A7C15UL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9UL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBUL;
+    return z ^ (z >> 31);
+}
+__kernel void generate(global uint* output,
+                       const ulong seed,
+                       const ulong size)
+{
+    for (ulong i = get_global_id(0); i < size; i += get_global_size(0))
+    {
+        output[i] = (uint)(size + 419 - i + splitMix64(seed, i) % 133769);
+    }
+}
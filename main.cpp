@@ -7,51 +7,337 @@
 #include <numeric>
 #include <thread>
 #include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <ctime>
+#include <sstream>
+#include <atomic>
+#include "cpuReduction.hpp"
+#include "hostMemory.hpp"
+#include "windowReduction.hpp"
+#include "rangeIndex.hpp"
+#if __has_include(<execution>)
+#include <execution>
+#endif
+//libstdc++ (and older libc++) run the parallel policies serially without a TBB backend,
+//so the column only exists where std::reduce is known to use more than one thread
+#if defined(__cpp_lib_execution) && defined(__cpp_lib_parallel_algorithm) && (defined(HAVE_TBB) || defined(_MSC_VER))
+#define HAVE_PARALLEL_STL
+#endif
+#ifdef HAVE_TBB
+#include <tbb/parallel_reduce.h>
+#include <tbb/blocked_range.h>
+#endif
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
 
 #define GPU_TO_USE "gfx1032"
 #define PLATFORM_TO_USE "AMD Accelerated Parallel Processing"
-#define PROGRAM_SOURCE_PATH "..//sumReduction6.cl"
+#ifndef KERNEL_DIR
+#define KERNEL_DIR "..//"
+#endif
+#ifndef RESULTS_DIR
+#define RESULTS_DIR "../"
+#endif
+#if __has_include("gitCommit.hpp")
+#include "gitCommit.hpp" //regenerated on every build, see cmake_modules/GitCommit.cmake
+#endif
+#ifndef GIT_COMMIT
+#define GIT_COMMIT "unknown"
+#endif
+#define KERNEL_PATH(file) (std::string(KERNEL_DIR) + (file))
+#define RESULTS_PATH(file) (resultsDir + (file))
+#define PROGRAM_SOURCE_PATH KERNEL_PATH("sumReduction6.cl")
 #define LOCAL_SIZE 128
 #define WORK_GROUP_COUNT 64
 #define N_ELEMENTS (LOCAL_SIZE*WORK_GROUP_COUNT*(1 << 16)) //268435456 32768
 #define SEPARATOR "--------------------------------------------\n"
+#ifndef CL_DEVICE_WAVEFRONT_WIDTH_AMD
+#define CL_DEVICE_WAVEFRONT_WIDTH_AMD 0x4043
+#endif
+#ifndef CL_DEVICE_DEVICE_ENQUEUE_CAPABILITIES
+#define CL_DEVICE_DEVICE_ENQUEUE_CAPABILITIES 0x1070
+#endif
 #define CHECK_ERROR(err) if (err != CL_SUCCESS) { std::cerr << "OpenCL error: " << err << std::endl; exit(EXIT_FAILURE); }
 #define DATA_TYPE uint32_t
 #define MAX_DATA_SIZE_SHIFTS 16
-#define AVERAGE_OUT_OF 42
+//one extra sweep size, the middle one plus this, is no multiple of a chunk so the tail handling runs
+#define RAGGED_SIZE_OFFSET 17
+#define WARMUP_RUNS 3
+#define MIN_RUNS_PER_CELL 42
+#define MAX_RUNS_PER_CELL 420
+#define PRECISION_BATCH 14
+#define TARGET_PRECISION 0.02 //relative half width of the 95% confidence interval of the median
+#define BOOTSTRAP_RESAMPLES 1000
+#define BOOTSTRAP_SEED 1337
+#define STREAM_ELEMENTS (1 << 26) //256 MiB, well beyond any last level cache
+#define STREAM_REPEATS 10
+#define STREAM_GROUPS_PER_CU 16
+#define PERSISTENT_GROUPS_PER_CU 4 //resident groups per compute unit for the persistent threads kernel
+#define ACCUMULATOR_SWEEP {1, 2, 4, 8}
+#define PREFETCH_DISTANCE_SWEEP {256, 1024, 4096, 16384} //bytes ahead of the large-array CPU path
+#define SUM_ARITHMETIC_INTENSITY 0.25 //one add per 4 byte element
+#define REGRESSION_THRESHOLD 0.05 //slowdowns of the median below 5% are never flagged
+#define REGRESSION_P_VALUE 0.01
+#define INCREMENTAL_UPDATE_FRACTION 0.01 //share of the array rewritten before each incremental re-reduction
+#define INCREMENTAL_UPDATE_REGIONS 4 //the rewritten share is spread over this many regions
+#define WINDOW_STREAM_ELEMENTS (1 << 26) //length of the simulated feed of the window mode
+#define WINDOW_BATCH 4096 //elements appended per push in the window mode
+#define WINDOW_DEVICE_THRESHOLD (1 << 20) //tumbling windows from this length are summed on the device
+#define RANGE_INDEX_ELEMENTS (1 << 26) //column size of the range query mode
+#define RANGE_CHECKED_QUERIES 16 //queries verified against a full scan
+#define MPI_SHARD_ELEMENTS (1 << 26) //elements generated by every rank
+#define MPI_BATCHES 8 //the overlapped combine reduces the shard in this many batches
+#define SERVER_MAGIC 0x44455250 //"PRED" in the first four bytes of every request
+#define SERVER_SUM 1
+#define SERVER_SHUTDOWN 2
+#define SERVER_MAX_ELEMENTS N_ELEMENTS
+#define SERVER_BACKLOG 16
+#define SERVER_TIMEOUT_SECONDS 5 //an idle or stuck client is dropped after this long
+#define SERVER_STATUS_OK 0
+#define SERVER_STATUS_BAD_REQUEST 1
+#define SERVER_STATUS_TOO_LARGE 2
+#define SERVER_STATUS_DEVICE_ERROR 3
 
 uint32_t measureSetupTime = 0;
-uint32_t sumReductionCpu(std::vector<uint32_t>* array, uint64_t size);
-
-std::vector<uint32_t>* createdArray(uint32_t size);
+std::string resultsDir = RESULTS_DIR;
+//extra options passed to every kernel build, recorded in the results metadata
+std::string kernelBuildOptions = "";
+//same seed, same inputs: runs with equal seeds are directly comparable
+uint64_t inputSeed = INPUT_SEED;
+//device variants copy their input from a buffer generated on the device instead of uploading it
+bool deviceResidentInput = false;
+cl::Buffer residentInput;
+uint32_t sumReductionCpu(const uint32_t* array, uint64_t size);
+
+HostArray* createdArray(uint32_t size);
 int SingleTest(void);
 
+struct RunStatistics
+{
+    std::vector<uint64_t> samples;
+    uint64_t min = 0;
+    uint64_t median = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double ciLow = 0.0;
+    double ciHigh = 0.0;
+};
+struct PhaseTimes
+{
+    uint64_t upload = 0;
+    std::vector<uint64_t> kernels;
+    std::vector<uint64_t> copies;
+    uint64_t readback = 0;
+};
+struct Variant
+{
+    std::string name;
+    std::string fileName;
+    bool isDevice;
+    std::function<uint64_t(uint32_t& correctResult, HostArray* arr, size_t size)> run;
+    bool enabled = true; //false when the device lacks what the kernel needs
+    bool anySize = false; //true when sizes that are no multiple of LOCAL_SIZE are reduced correctly
+};
+struct BandwidthPeaks
+{
+    //best of STREAM_REPEATS in GB/s
+    double hostRead = 0.0;
+    double hostCopy = 0.0;
+    double deviceRead = 0.0;
+    double deviceCopy = 0.0;
+};
+struct ResultRecord
+{
+    //one parsed line of results.jsonl
+    std::map<std::string, std::string> strings;
+    std::map<std::string, double> numbers;
+    std::map<std::string, std::vector<double>> arrays;
+};
+struct IncrementalReduction
+{
+    //input plus every level of block partials, kept on the device between updates
+    cl::Kernel kernel;
+    cl::Buffer data;
+    std::vector<cl::Buffer> levels;
+    std::vector<size_t> levelCounts;
+    size_t size = 0;
+    std::vector<std::pair<size_t, size_t>> dirty; //element ranges [begin, end) changed since the last total
+    std::vector<cl::Event> kernelEvents;
+};
+struct DeviceBufferPool
+{
+    //ping-pong pair of reduceOnDevice, only reallocated when a larger input arrives
+    cl::Buffer input;
+    cl::Buffer output;
+    size_t capacity = 0;
+};
+struct ServerRequest
+{
+    uint32_t magic;
+    uint32_t opcode;
+    uint64_t count; //followed by count DATA_TYPE elements for SERVER_SUM
+};
+struct ServerResponse
+{
+    uint32_t status; //0 on success
+    uint32_t result;
+    uint64_t deviceTime; //mus between receiving the data and having the sum
+};
+PhaseTimes lastPhases; //profiling breakdown of the most recent device test run
+
+
 int testHost();
-uint64_t test1SingleCoreCPU(uint32_t* correctResult, std::vector<uint32_t>* arr, size_t size);
-void test2MultiCoreCPUPartialSum(const std::vector<uint32_t>& arr, size_t start, size_t end, uint32_t& result);
-uint64_t test2MultiCoreCPU(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size);
-uint64_t test3Dournac(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
-uint64_t test4Catanzaro(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
-uint64_t test5Divergence(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
-uint64_t test6LoopUnrolling(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
-uint64_t test7ProducerConsumer(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
-uint64_t test8Coalesced(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+void selectDevice(cl::Platform& platformToUse, cl::Device& deviceToUse, std::vector<cl::Device>& devicesToUse);
+int testWindows(size_t window);
+int testRangeQueries(size_t queries);
+int testMpi();
+uint32_t reduceShard(const uint32_t* data, size_t size, size_t threadCount, const std::function<void()>& progress);
+cl_int reduceOnDevice(cl::Context context, cl::CommandQueue& commandQueue, cl::Kernel& kernel, DeviceBufferPool& pool, const uint32_t* data, size_t size, uint32_t* result);
+int runServer(const std::string& socketPath);
+int runClient(const std::string& socketPath, size_t elements);
+int stopServer(const std::string& socketPath);
+int connectServer(const std::string& socketPath);
+bool readFully(int socket, void* buffer, size_t bytes);
+bool writeFully(int socket, const void* buffer, size_t bytes);
+int variantColumnWidth(const Variant& variant);
+RunStatistics measureVariant(const std::function<uint64_t()>& run);
+void computeStatistics(RunStatistics& stats);
+uint64_t medianOf(std::vector<uint64_t> values);
+uint64_t eventDuration(const cl::Event& event);
+void recordPhases(const cl::Event& upload, const std::vector<cl::Event>& kernels, const std::vector<cl::Event>& copies, const cl::Event& readback);
+void writePhases(std::ofstream& file, size_t elementCount, const Variant& variant, std::vector<PhaseTimes>& phases);
+BandwidthPeaks measureBandwidthPeaks(cl::Context context, cl::CommandQueue commandQueue, cl::Device device, std::vector<cl::Device>& devicesToUse);
+cl::Buffer generateDeviceInput(cl::Context context, cl::CommandQueue commandQueue, cl::Device device, std::vector<cl::Device>& devicesToUse, size_t size, uint64_t seed);
+cl_int uploadInput(cl::CommandQueue& commandQueue, cl::Buffer& target, HostArray* arr, size_t sizeData, cl::Event* uploadEvent);
+double bandwidthGBs(size_t elementCount, uint64_t microseconds);
+std::string jsonString(const std::string& text);
+bool parseResultRecord(const std::string& line, ResultRecord& record);
+std::vector<ResultRecord> loadResults(const char* path);
+double mannWhitneySlowerPValue(const std::vector<double>& baseline, const std::vector<double>& current);
+int compareResults(const char* baselinePath, const char* currentPath);
+uint64_t test1SingleCoreCPU(uint32_t* correctResult, const uint32_t* arr, size_t size);
+void test2MultiCoreCPUPartialSum(const uint32_t* arr, size_t start, size_t end, uint32_t& result);
+uint64_t test2MultiCoreCPU(uint32_t correctResult, const uint32_t* arr, size_t size);
+uint64_t test22LargeArrayCPU(uint32_t correctResult, const uint32_t* arr, size_t size, size_t prefetchDistance = CPU_PREFETCH_DISTANCE);
+//the backend columns only exist when their backend was found
+#ifdef HAVE_PARALLEL_STL
+uint64_t test19StdReduce(uint32_t correctResult, const uint32_t* arr, size_t size);
+#endif
+#ifdef HAVE_OPENMP
+uint64_t test20OpenMP(uint32_t correctResult, const uint32_t* arr, size_t size);
+#endif
+#ifdef HAVE_TBB
+uint64_t test21TBB(uint32_t correctResult, const uint32_t* arr, size_t size);
+#endif
+uint64_t test3Dournac(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test4Catanzaro(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test5Divergence(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test6LoopUnrolling(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test11TailSplit(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test7ProducerConsumer(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test15ProConInterleaved(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test16AsyncPrefetch(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test8Coalesced(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+uint64_t test9Subgroups(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions);
+uint64_t test17PersistentThreads(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, size_t persistentGroups);
+uint64_t test18DeviceEnqueue(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, bool deviceEnqueue);
+uint64_t test14MultiAccumulator(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions);
+uint64_t test12UnrolledTree(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions);
+uint64_t test13GlobalAtomic(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions);
+uint64_t test10VectorLoads(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions);
+uint64_t test23Incremental(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse);
+IncrementalReduction createIncrementalReduction(cl::Context context, cl::CommandQueue& commandQueue, std::vector<cl::Device>& devicesToUse, HostArray* arr, size_t size);
+void updateIncremental(IncrementalReduction& state, cl::CommandQueue& commandQueue, size_t offset, const uint32_t* values, size_t count, cl::Event* uploadEvent);
+uint32_t incrementalTotal(IncrementalReduction& state, cl::CommandQueue& commandQueue, cl::Event* readbackEvent);
+void reduceIncrementalBlocks(IncrementalReduction& state, cl::CommandQueue& commandQueue, size_t level, size_t firstBlock, size_t blockCount);
+bool deviceHasExtension(const cl::Device& device, const std::string& extension);
+std::string subgroupBuildOptions(const cl::Device& device);
+std::string vectorWidthBuildOptions(const cl::Device& device);
+std::string unrolledTreeBuildOptions(const cl::Device& device);
+std::string globalAtomicBuildOptions(const cl::Device& device);
+cl_command_queue createDeviceQueue(cl::Context context, cl::Device device);
 
 int main(int arg, char* args[])
 {
+    for(int i = 1; i < arg; i++)
+    {
+        std::string option(args[i]);
+        if(option == "--results-dir" && i + 1 < arg)
+        {
+            resultsDir = std::string(args[++i]) + "/";
+        }
+        else if(option == "--seed" && i + 1 < arg)
+        {
+            inputSeed = std::strtoull(args[++i], nullptr, 0);
+        }
+        else if(option == "--build-options" && i + 1 < arg)
+        {
+            kernelBuildOptions = args[++i];
+        }
+        else if(option == "--device-input")
+        {
+            deviceResidentInput = true;
+        }
+        else if(option == "--window" && i + 1 < arg)
+        {
+            return testWindows(std::strtoull(args[++i], nullptr, 0));
+        }
+        else if(option == "--range-queries" && i + 1 < arg)
+        {
+            return testRangeQueries(std::strtoull(args[++i], nullptr, 0));
+        }
+        else if(option == "--mpi")
+        {
+            return testMpi();
+        }
+        else if(option == "--serve" && i + 1 < arg)
+        {
+            return runServer(args[i + 1]);
+        }
+        else if(option == "--client" && i + 2 < arg)
+        {
+            return runClient(args[i + 1], std::strtoull(args[i + 2], nullptr, 0));
+        }
+        else if(option == "--stop" && i + 1 < arg)
+        {
+            return stopServer(args[i + 1]);
+        }
+        else if(option == "--compare" && i + 2 < arg)
+        {
+            return compareResults(args[i + 1], args[i + 2]);
+        }
+        else
+        {
+            std::cerr << "usage: " << args[0] << " [--results-dir <dir>] [--seed <n>] [--build-options <options>] [--device-input] [--window <length>] [--range-queries <count>] [--mpi] [--serve <socket>] [--client <socket> <elements>] [--stop <socket>] [--compare <baseline.jsonl> <current.jsonl>]\n";
+            return EXIT_FAILURE;
+        }
+    }
     testHost();
     //SingleTest();
 }
 
 int SingleTest(void)
 {
-    std::vector<uint32_t>* testArray = createdArray(N_ELEMENTS);
+    HostArray* testArray = createdArray(N_ELEMENTS);
     auto astart_time = std::chrono::steady_clock::now();
     auto aend_time = std::chrono::steady_clock::now();
     cl_int err;
 
     uint32_t test = 0;
-    std::cout << test1SingleCoreCPU(&test, testArray, N_ELEMENTS);
+    std::cout << test1SingleCoreCPU(&test, testArray->data(), N_ELEMENTS);
     std::cout << "\t\t" << test << "\n";
 
     std::vector<cl::Platform> platforms;
@@ -96,7 +382,7 @@ int SingleTest(void)
     std::cout << SEPARATOR;
     std::cout << "CPU:\n";
     astart_time = std::chrono::steady_clock::now();
-    uint32_t cpuSum = sumReductionCpu(testArray, N_ELEMENTS);
+    uint32_t cpuSum = sumReductionCpu(testArray->data(), N_ELEMENTS);
     std::cout << "sum: " << cpuSum << " - ";
     aend_time = std::chrono::steady_clock::now();
     std::cout << std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count() << "mus\n";
@@ -166,13 +452,10 @@ int SingleTest(void)
     return 0;
 }
 
-int testHost()
+void selectDevice(cl::Platform& platformToUse, cl::Device& deviceToUse, std::vector<cl::Device>& devicesToUse)
 {
     std::vector<cl::Platform> platforms;
     cl::Platform::get(&platforms);
-    cl::Platform platformToUse;
-    cl::Device deviceToUse;
-    std::vector<cl::Device> devicesToUse;
 
     //choose device
     for(cl::Platform currentPlatform : platforms)
@@ -194,263 +477,1295 @@ int testHost()
         }
     }
     platformToUse.getDevices(CL_DEVICE_TYPE_ALL, &devicesToUse);
+}
+int testWindows(size_t window)
+{
+    cl::Platform platformToUse;
+    cl::Device deviceToUse;
+    std::vector<cl::Device> devicesToUse;
+    selectDevice(platformToUse, deviceToUse, devicesToUse);
     cl::Context context(devicesToUse);
     cl::CommandQueue commandQueue(context, deviceToUse);
-    std::ofstream* currentFile;
-    std::ofstream withoutStartup("../withoutStartup.csv");
-    std::ofstream withStartup("../withStartup.csv");
 
-    std::vector<std::ofstream> deviations(8);
-    std::vector<std::ofstream> deviationsStartup(6);
-
-    deviations[0] = std::ofstream("../singleResults/singleCPU.csv");
-    deviations[1] = std::ofstream("../singleResults/multiCPU.csv");
+    cl_int err;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction17.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
 
-    deviations[2] = std::ofstream("../singleResults/Dournac.csv");
-    deviationsStartup[0] = std::ofstream("../singleResults/DournacStartup.csv");
+    HostArray* feed = createdArray(WINDOW_STREAM_ELEMENTS);
+    const uint32_t* data = feed->data();
+    std::cout << "window " << window << ", feed of " << WINDOW_STREAM_ELEMENTS << " elements in batches of " << WINDOW_BATCH << "\n";
 
-    deviations[3] = std::ofstream("../singleResults/Catanzaro.csv");
-    deviationsStartup[1] = std::ofstream("../singleResults/CatanzaroStartup.csv");
+    //sliding sum, min and max, queried after every batch
+    SlidingWindow<uint32_t, SumOperator> slidingSum(window);
+    SlidingWindow<uint32_t, MinOperator> slidingMin(window);
+    SlidingWindow<uint32_t, MaxOperator> slidingMax(window);
+    uint32_t checksum = 0;
+    auto astart_time = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < WINDOW_STREAM_ELEMENTS; i += WINDOW_BATCH)
+    {
+        size_t count = std::min<size_t>(WINDOW_BATCH, WINDOW_STREAM_ELEMENTS - i);
+        slidingSum.push(data + i, count);
+        slidingMin.push(data + i, count);
+        slidingMax.push(data + i, count);
+        checksum += slidingSum.value() ^ slidingMin.value() ^ slidingMax.value();
+    }
+    auto aend_time = std::chrono::steady_clock::now();
+    uint64_t slidingTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+    size_t lastStart = WINDOW_STREAM_ELEMENTS > window ? WINDOW_STREAM_ELEMENTS - window : 0;
+    if(slidingSum.value() != reduceCpu<uint32_t>(data + lastStart, WINDOW_STREAM_ELEMENTS - lastStart) ||
+       slidingMin.value() != reduceCpu<uint32_t, MinOperator>(data + lastStart, WINDOW_STREAM_ELEMENTS - lastStart) ||
+       slidingMax.value() != reduceCpu<uint32_t, MaxOperator>(data + lastStart, WINDOW_STREAM_ELEMENTS - lastStart)){exit(-69);}
+    printf("sliding sum/min/max: %llu mus, %.1f M elements/s (checksum %u)\n", static_cast<unsigned long long>(slidingTime),
+           slidingTime > 0 ? WINDOW_STREAM_ELEMENTS / static_cast<double>(slidingTime) : 0.0, checksum);
+
+    //tumbling sums, long windows go through the device kernel
+    TumblingWindow<uint32_t, SumOperator> tumblingSum(window);
+    BlockReducer<uint32_t, SumOperator> deviceReducer;
+    DeviceBufferPool pool;
+    deviceReducer.external = [&](const uint32_t* block, size_t size)
+    {
+        uint32_t sum = 0;
+        cl_int err = reduceOnDevice(context, commandQueue, kernel, pool, block, size, &sum); CHECK_ERROR(err);
+        return sum;
+    };
+    deviceReducer.minimumSize = WINDOW_DEVICE_THRESHOLD;
+    tumblingSum.setBlockReducer(deviceReducer);
+    std::vector<uint32_t> sums;
+    astart_time = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < WINDOW_STREAM_ELEMENTS; i += WINDOW_BATCH)
+    {
+        size_t count = std::min<size_t>(WINDOW_BATCH, WINDOW_STREAM_ELEMENTS - i);
+        tumblingSum.push(data + i, count, [&](uint32_t sum) { sums.push_back(sum); });
+    }
+    aend_time = std::chrono::steady_clock::now();
+    uint64_t tumblingTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+    if(!sums.empty() && sums.back() != reduceCpu<uint32_t>(data + (sums.size() - 1) * window, window)){exit(-69);}
+    size_t deviceWindows = tumblingSum.blockReducer().externalCalls;
+    //every completed long window has to have gone through the device kernel
+    if(window >= WINDOW_DEVICE_THRESHOLD && deviceWindows != sums.size()){exit(-69);}
+    printf("tumbling sum (%s): %llu mus, %.1f M elements/s, %zu windows\n", deviceWindows > 0 ? "device" : "CPU",
+           static_cast<unsigned long long>(tumblingTime), tumblingTime > 0 ? WINDOW_STREAM_ELEMENTS / static_cast<double>(tumblingTime) : 0.0, sums.size());
+
+    delete(feed);
+    return 0;
+}
+int testRangeQueries(size_t queries)
+{
+    HostArray* column = createdArray(RANGE_INDEX_ELEMENTS);
+    const uint32_t* data = column->data();
 
-    deviations[4] = std::ofstream("../singleResults/Divergence.csv");
-    deviationsStartup[2] = std::ofstream("../singleResults/DivergenceStartup.csv");
+    //same fanout as one pass of the device kernels
+    auto astart_time = std::chrono::steady_clock::now();
+    RangeIndex<uint32_t, SumOperator> sumIndex(data, RANGE_INDEX_ELEMENTS, LOCAL_SIZE);
+    RangeIndex<uint32_t, MinOperator> minIndex(data, RANGE_INDEX_ELEMENTS, LOCAL_SIZE);
+    RangeIndex<uint32_t, MaxOperator> maxIndex(data, RANGE_INDEX_ELEMENTS, LOCAL_SIZE);
+    auto aend_time = std::chrono::steady_clock::now();
+    uint64_t buildTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+    std::cout << "index over " << RANGE_INDEX_ELEMENTS << " elements, " << sumIndex.levelCount() << " levels, built in " << buildTime << "mus\n";
 
-    deviations[5] = std::ofstream("../singleResults/Loop.csv");
-    deviationsStartup[3] = std::ofstream("../singleResults/LoopStartup.csv");
+    std::mt19937_64 generator(inputSeed);
+    std::vector<std::pair<size_t, size_t>> ranges(queries);
+    for(std::pair<size_t, size_t>& range : ranges)
+    {
+        range.first = generator() % RANGE_INDEX_ELEMENTS;
+        range.second = range.first + generator() % (RANGE_INDEX_ELEMENTS - range.first + 1);
+    }
+    uint32_t checksum = 0;
+    astart_time = std::chrono::steady_clock::now();
+    for(const std::pair<size_t, size_t>& range : ranges)
+    {
+        checksum += sumIndex.query(range.first, range.second) ^ minIndex.query(range.first, range.second) ^ maxIndex.query(range.first, range.second);
+    }
+    aend_time = std::chrono::steady_clock::now();
+    uint64_t queryTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+    printf("%zu sum/min/max queries: %llu mus, %.2f mus per query (checksum %u)\n", queries, static_cast<unsigned long long>(queryTime),
+           queries > 0 ? queryTime / static_cast<double>(queries) : 0.0, checksum);
 
-    deviations[6] = std::ofstream("../singleResults/ProCon.csv");
-    deviationsStartup[4] = std::ofstream("../singleResults/ProConStartup.csv");
+    for(size_t q = 0; q < std::min<size_t>(queries, RANGE_CHECKED_QUERIES); q++)
+    {
+        const uint32_t* begin = data + ranges[q].first;
+        size_t count = ranges[q].second - ranges[q].first;
+        if(sumIndex.query(ranges[q].first, ranges[q].second) != reduceCpu<uint32_t>(begin, count) ||
+           minIndex.query(ranges[q].first, ranges[q].second) != reduceCpu<uint32_t, MinOperator>(begin, count) ||
+           maxIndex.query(ranges[q].first, ranges[q].second) != reduceCpu<uint32_t, MaxOperator>(begin, count)){exit(-69);}
+    }
+    delete(column);
+    return 0;
+}
+int testMpi()
+{
+#ifdef HAVE_MPI
+    //only the main thread calls MPI, but worker threads reduce while it does
+    int provided = MPI_THREAD_SINGLE;
+    MPI_Init_thread(nullptr, nullptr, MPI_THREAD_FUNNELED, &provided);
+    bool threaded = provided >= MPI_THREAD_FUNNELED;
+    int rank = 0;
+    int ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+    //ranks sharing a box split its cores
+    MPI_Comm nodeComm;
+    int nodeRanks = 1;
+    MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+    MPI_Comm_size(nodeComm, &nodeRanks);
+    MPI_Comm_free(&nodeComm);
+    //without funneled support the shard is reduced on the main thread and nothing overlaps
+    size_t threadCount = threaded ? std::max<size_t>(1, std::thread::hardware_concurrency() / nodeRanks) : 1;
+
+    //every rank generates its own shard, seeded by its rank
+    HostArray* shard = new HostArray(MPI_SHARD_ELEMENTS);
+    fillInput(shard->data(), MPI_SHARD_ELEMENTS, inputSeed + rank);
+    const uint32_t* data = shard->data();
+    uint32_t localReference = reduceCpu<uint32_t>(data, MPI_SHARD_ELEMENTS);
+    uint32_t reference = 0;
+    MPI_Allreduce(&localReference, &reference, 1, MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD);
+
+    //local reduction of the whole shard, then one combine to rank 0
+    uint32_t reduced = 0;
+    MPI_Barrier(MPI_COMM_WORLD);
+    auto astart_time = std::chrono::steady_clock::now();
+    uint32_t local = reduceShard(data, MPI_SHARD_ELEMENTS, threadCount, nullptr);
+    MPI_Reduce(&local, &reduced, 1, MPI_UINT32_T, MPI_SUM, 0, MPI_COMM_WORLD);
+    auto aend_time = std::chrono::steady_clock::now();
+    double reduceTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+    if(rank == 0 && reduced != reference){MPI_Abort(MPI_COMM_WORLD, -69);}
 
-    deviations[7] = std::ofstream("../singleResults/Coalesced.csv");
-    deviationsStartup[5] = std::ofstream("../singleResults/CoalescedStartup.csv");
+    //same, but every rank ends up with the total
+    MPI_Barrier(MPI_COMM_WORLD);
+    astart_time = std::chrono::steady_clock::now();
+    local = reduceShard(data, MPI_SHARD_ELEMENTS, threadCount, nullptr);
+    MPI_Allreduce(&local, &reduced, 1, MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD);
+    aend_time = std::chrono::steady_clock::now();
+    double allreduceTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+    if(reduced != reference){MPI_Abort(MPI_COMM_WORLD, -69);}
+
+    //batched without overlap: every batch is combined before the next one is reduced
+    std::vector<uint32_t> partials(MPI_BATCHES);
+    std::vector<uint32_t> combined(MPI_BATCHES);
+    size_t batchSize = MPI_SHARD_ELEMENTS / MPI_BATCHES;
+    MPI_Barrier(MPI_COMM_WORLD);
+    astart_time = std::chrono::steady_clock::now();
+    for(size_t b = 0; b < MPI_BATCHES; b++)
+    {
+        size_t count = b == MPI_BATCHES - 1 ? MPI_SHARD_ELEMENTS - b * batchSize : batchSize;
+        partials[b] = reduceShard(data + b * batchSize, count, threadCount, nullptr);
+        MPI_Allreduce(&partials[b], &combined[b], 1, MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD);
+    }
+    reduced = reduceCpu<uint32_t, SumOperator, 1, 1>(combined.data(), combined.size());
+    aend_time = std::chrono::steady_clock::now();
+    double batchedTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+    if(reduced != reference){MPI_Abort(MPI_COMM_WORLD, -69);}
+
+    //batched: the combine of batch b is in flight while batch b + 1 is reduced locally
+    //Most MPI libraries only progress a nonblocking collective inside MPI calls, so the main
+    //thread polls MPI_Test on the outstanding requests while the workers reduce the next batch.
+    std::vector<MPI_Request> requests(MPI_BATCHES, MPI_REQUEST_NULL);
+    size_t issued = 0;
+    auto progress = [&]()
+    {
+        for(size_t k = 0; k < issued; k++)
+        {
+            int done = 0;
+            MPI_Test(&requests[k], &done, MPI_STATUS_IGNORE);
+        }
+    };
+    double overlappedTime = 0.0;
+    if(threaded)
+    {
+        std::fill(combined.begin(), combined.end(), 0);
+        MPI_Barrier(MPI_COMM_WORLD);
+        astart_time = std::chrono::steady_clock::now();
+        for(size_t b = 0; b < MPI_BATCHES; b++)
+        {
+            size_t count = b == MPI_BATCHES - 1 ? MPI_SHARD_ELEMENTS - b * batchSize : batchSize;
+            partials[b] = reduceShard(data + b * batchSize, count, threadCount, progress);
+            issued = b + 1;
+            MPI_Iallreduce(&partials[b], &combined[b], 1, MPI_UINT32_T, MPI_SUM, MPI_COMM_WORLD, &requests[b]);
+        }
+        MPI_Waitall(MPI_BATCHES, requests.data(), MPI_STATUSES_IGNORE);
+        reduced = reduceCpu<uint32_t, SumOperator, 1, 1>(combined.data(), combined.size());
+        aend_time = std::chrono::steady_clock::now();
+        overlappedTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+        if(reduced != reference){MPI_Abort(MPI_COMM_WORLD, -69);}
+    }
 
-    currentFile = &withoutStartup;
+    //the slowest rank is the time of the distributed reduction
+    double times[4] = {reduceTime, allreduceTime, batchedTime, overlappedTime};
+    double slowest[4] = {0.0, 0.0, 0.0, 0.0};
+    MPI_Reduce(times, slowest, 4, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    if(rank == 0)
+    {
+        std::cout << ranks << " ranks x " << MPI_SHARD_ELEMENTS << " elements, " << threadCount << " threads per rank, sum " << reference << "\n";
+        printf("local + MPI_Reduce:      %10.0f mus, %.2f GB/s\n", slowest[0], bandwidthGBs(static_cast<uint64_t>(ranks) * MPI_SHARD_ELEMENTS, static_cast<uint64_t>(slowest[0])));
+        printf("local + MPI_Allreduce:   %10.0f mus, %.2f GB/s\n", slowest[1], bandwidthGBs(static_cast<uint64_t>(ranks) * MPI_SHARD_ELEMENTS, static_cast<uint64_t>(slowest[1])));
+        printf("batched MPI_Allreduce:   %10.0f mus, %.2f GB/s\n", slowest[2], bandwidthGBs(static_cast<uint64_t>(ranks) * MPI_SHARD_ELEMENTS, static_cast<uint64_t>(slowest[2])));
+        if(threaded)
+        {
+            printf("batched MPI_Iallreduce:  %10.0f mus, %.2f GB/s\n", slowest[3], bandwidthGBs(static_cast<uint64_t>(ranks) * MPI_SHARD_ELEMENTS, static_cast<uint64_t>(slowest[3])));
+        }
+        else
+        {
+            printf("batched MPI_Iallreduce:         n/a, the MPI library does not provide MPI_THREAD_FUNNELED\n");
+        }
+    }
+    delete(shard);
+    MPI_Finalize();
+    return 0;
+#else
+    std::cerr << "built without MPI\n";
+    return EXIT_FAILURE;
+#endif
+}
+uint32_t reduceShard(const uint32_t* data, size_t size, size_t threadCount, const std::function<void()>& progress)
+{
+    if(threadCount == 1 && !progress)
+    {
+        return reduceCpuAuto(data, size);
+    }
+    std::vector<std::thread> threads(threadCount);
+    std::vector<uint32_t> results(threadCount, 0);
+    std::atomic<size_t> finished(0);
+    size_t chunkSize = size / threadCount;
+    for(size_t i = 0; i < threadCount; i++)
+    {
+        size_t start = i * chunkSize;
+        size_t end = (i == threadCount - 1) ? size : start + chunkSize;
+        threads[i] = std::thread([data, start, end, i, &results, &finished]()
+        {
+            results[i] = reduceCpuAuto(data + start, end - start);
+            finished++;
+        });
+    }
+    //the calling thread is free while the workers run, e.g. to drive outstanding communication
+    while(progress && finished < threadCount)
+    {
+        progress();
+        std::this_thread::yield();
+    }
+    for(std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    return reduceCpu<uint32_t, SumOperator, 1, 1>(results.data(), results.size());
+}
+cl_int reduceOnDevice(cl::Context context, cl::CommandQueue& commandQueue, cl::Kernel& kernel, DeviceBufferPool& pool, const uint32_t* data, size_t size, uint32_t* result)
+{
+    //ping-pong over the levels with the bounds checked block kernel of sumReduction17.cl.
+    //Errors are returned instead of exiting, the server has to survive a failed request.
+    cl_int err = CL_SUCCESS;
+    if(size > pool.capacity)
+    {
+        pool.capacity = 0;
+        pool.input = cl::Buffer(context, CL_MEM_READ_WRITE, size * sizeof(DATA_TYPE), nullptr, &err);
+        if(err != CL_SUCCESS) return err;
+        pool.output = cl::Buffer(context, CL_MEM_READ_WRITE, std::max<size_t>(1, (size + LOCAL_SIZE - 1) / LOCAL_SIZE) * sizeof(DATA_TYPE), nullptr, &err);
+        if(err != CL_SUCCESS) return err;
+        pool.capacity = size;
+    }
+    cl::Buffer input = pool.input;
+    cl::Buffer output = pool.output;
+    err = commandQueue.enqueueWriteBuffer(input, CL_FALSE, 0, size * sizeof(DATA_TYPE), data);
+    if(err != CL_SUCCESS) return err;
+    cl_int firstGroup = 0;
+    size_t count = size;
+    do
+    {
+        cl_int length = count;
+        count = (count + LOCAL_SIZE - 1) / LOCAL_SIZE;
+        err |= kernel.setArg(0, input);
+        err |= kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE)));
+        err |= kernel.setArg(2, sizeof(cl_int), &length);
+        err |= kernel.setArg(3, sizeof(cl_int), &firstGroup);
+        err |= kernel.setArg(4, output);
+        if(err != CL_SUCCESS) return err;
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(count * LOCAL_SIZE), cl::NDRange(LOCAL_SIZE));
+        if(err != CL_SUCCESS) return err;
+        std::swap(input, output);
+    } while(count > 1);
+    DATA_TYPE total = 0;
+    err = commandQueue.enqueueReadBuffer(input, CL_TRUE, 0, sizeof(DATA_TYPE), &total);
+    if(err != CL_SUCCESS) return err;
+    *result = total;
+    return CL_SUCCESS;
+}
+int runServer(const std::string& socketPath)
+{
+    //platform discovery, compilation and buffers are paid once, every request only pays transfer and kernels
+    cl::Platform platformToUse;
+    cl::Device deviceToUse;
+    std::vector<cl::Device> devicesToUse;
+    selectDevice(platformToUse, deviceToUse, devicesToUse);
+    cl::Context context(devicesToUse);
+    cl::CommandQueue commandQueue(context, deviceToUse);
 
-    for(int h = 0; h < 8; h++)
+    cl_int err;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction17.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+    DeviceBufferPool pool;
+    HostArray staging;
+    //the input buffer is one allocation, larger requests are refused instead of failing in the driver
+    size_t maxElements = std::min<size_t>(SERVER_MAX_ELEMENTS, deviceToUse.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>() / sizeof(DATA_TYPE));
+    std::cout << "accepting up to " << maxElements << " elements per request\n";
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if(socketPath.size() >= sizeof(address.sun_path))
     {
-        deviations[h] <<"Elements, Results\n";
+        std::cerr << "socket path too long: " << socketPath << "\n";
+        return EXIT_FAILURE;
     }
-    for(int h = 0; h < 6; h++)
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    //only replace a stale socket, never an unrelated file behind a mistyped path
+    struct stat existing;
+    if(lstat(socketPath.c_str(), &existing) == 0)
     {
-        deviationsStartup[h] <<"Elements, Results\n";
+        if(!S_ISSOCK(existing.st_mode))
+        {
+            std::cerr << socketPath << " exists and is not a socket\n";
+            return EXIT_FAILURE;
+        }
+        unlink(socketPath.c_str());
     }
-    for(int g = 0; g < 2; g++)
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, SERVER_BACKLOG) != 0)
     {
-        if(measureSetupTime)
+        std::perror("socket");
+        return EXIT_FAILURE;
+    }
+    std::cout << "serving on " << socketPath << "\n";
+
+    bool running = true;
+    while(running)
+    {
+        int client = accept(listener, nullptr, nullptr);
+        if(client < 0)
         {
-            std::cout << "--- Measurements with startup of kernel ---\n";
+            continue;
         }
-        std::printf("%10s|%15s|%15s|%7s|%10s|%12s|%15s|%16s|%10s|\n",
-                    "Elements",
-                    "SingleCore CPU",
-                    "MultiCore CPU",
-                    "Dournac",
-                    "Catanzaro",
-                    "-Divergence",
-                    "Loop unrolling",
-                    "ProducerConsumer",
-                    "Coalesced");
-        (*currentFile) <<  "Elements, SingleCore CPU, MultiCore CPU, Dournac, Catanzaro, Divergence, Loop unrolling, ProducerConsumer, Coalesced\n";
-
-        uint64_t avg = 0;
-        for (int i = 0; i < MAX_DATA_SIZE_SHIFTS; i++)
-        {
-            size_t elementCount = LOCAL_SIZE * WORK_GROUP_COUNT * (1 << i);
-            (*currentFile) << elementCount << ", ";
-            if(!measureSetupTime)
+        //jobs are served one connection at a time, a client that stops sending must not block the others
+        timeval timeout = {SERVER_TIMEOUT_SECONDS, 0};
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        //any number of requests per connection, answered in order
+        ServerRequest request;
+        while(readFully(client, &request, sizeof(request)))
+        {
+            ServerResponse response = {SERVER_STATUS_OK, 0, 0};
+            if(request.magic != SERVER_MAGIC || (request.opcode != SERVER_SUM && request.opcode != SERVER_SHUTDOWN))
             {
-                for(int h = 0; h < 8; h++)
-                {
-                    deviations[h] << elementCount << ", ";
-                }
+                response.status = SERVER_STATUS_BAD_REQUEST;
+                writeFully(client, &response, sizeof(response));
+                break;
             }
-            else
+            if(request.opcode == SERVER_SUM && request.count > maxElements)
             {
-                for(int h = 0; h < 6; h++)
-                {
-                    deviationsStartup[h] << elementCount << ", ";
-                }
+                response.status = SERVER_STATUS_TOO_LARGE;
+                writeFully(client, &response, sizeof(response));
+                break;
             }
-            printf("%10llu|", elementCount);
-            std::vector<uint32_t> *testArray = createdArray(elementCount);
-            uint32_t correctResult = 0U;
-
-            //1
-            for (int j = 0; j < AVERAGE_OUT_OF; j++)
+            if(request.opcode == SERVER_SHUTDOWN)
             {
-                uint64_t temp = test1SingleCoreCPU(&correctResult, testArray, elementCount);
-                avg += temp;
-                if(!measureSetupTime)
-                {
-                    deviations[0] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
+                running = false;
+                writeFully(client, &response, sizeof(response));
+                break;
             }
-            deviations[0] << "\n";
-            printf("%15llu|", avg / AVERAGE_OUT_OF);
-            (*currentFile) << avg / AVERAGE_OUT_OF << ", ";
-            avg = 0;
-
-            //2
-            for (int j = 0; j < AVERAGE_OUT_OF; j++)
+            if(staging.size() < request.count)
             {
-                uint64_t temp = test2MultiCoreCPU(correctResult, testArray, elementCount);
-                avg += temp;
-                if(!measureSetupTime)
-                {
-                    deviations[1] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
+                staging.resize(request.count);
             }
-            printf("%15llu|", avg / AVERAGE_OUT_OF);
-            (*currentFile) << avg / AVERAGE_OUT_OF << ", ";
-            avg = 0;
-
-            //3
-            for (int j = 0; j < AVERAGE_OUT_OF; j++)
+            if(!readFully(client, staging.data(), request.count * sizeof(DATA_TYPE)))
             {
-                uint64_t temp = test3Dournac(correctResult, testArray, elementCount, context, commandQueue, devicesToUse);
-                avg += temp;
-                if(!measureSetupTime)
-                {
-                    deviations[2] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
-                else
-                {
-                    deviationsStartup[0] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
+                break;
             }
-            printf("%7llu|", avg / AVERAGE_OUT_OF);
-            (*currentFile) << avg / AVERAGE_OUT_OF << ", ";
-            avg = 0;
-
-            //4
-            for (int j = 0; j < AVERAGE_OUT_OF; j++)
+            auto astart_time = std::chrono::steady_clock::now();
+            if(request.count > 0)
             {
-                uint64_t temp = test4Catanzaro(correctResult, testArray, elementCount, context, commandQueue, devicesToUse);
-                avg += temp;
-                if(!measureSetupTime)
+                cl_int err = reduceOnDevice(context, commandQueue, kernel, pool, staging.data(), request.count, &response.result);
+                if(err != CL_SUCCESS)
                 {
-                    deviations[3] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
-                else
-                {
-                    deviationsStartup[1] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
+                    std::cerr << "OpenCL error " << err << " for a request of " << request.count << " elements\n";
+                    response.status = SERVER_STATUS_DEVICE_ERROR;
+                    response.result = 0;
                 }
             }
-            printf("%10llu|", avg / AVERAGE_OUT_OF);
-            (*currentFile) << avg / AVERAGE_OUT_OF << ", ";
-            avg = 0;
-
-            //5
-            for (int j = 0; j < AVERAGE_OUT_OF; j++)
+            auto aend_time = std::chrono::steady_clock::now();
+            response.deviceTime = std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+            if(!writeFully(client, &response, sizeof(response)))
             {
-                uint64_t temp = test5Divergence(correctResult, testArray, elementCount, context, commandQueue, devicesToUse);
-                avg += temp;
-                if(!measureSetupTime)
-                {
-                    deviations[4] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
-                else
-                {
-                    deviationsStartup[2] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
+                break;
             }
-            printf("%12llu|", avg / AVERAGE_OUT_OF);
-            (*currentFile) << avg / AVERAGE_OUT_OF << ", ";
-            avg = 0;
+        }
+        close(client);
+    }
+    close(listener);
+    unlink(socketPath.c_str());
+    return 0;
+}
+int runClient(const std::string& socketPath, size_t elements)
+{
+    if(elements > SERVER_MAX_ELEMENTS)
+    {
+        std::cerr << "at most " << SERVER_MAX_ELEMENTS << " elements per request\n";
+        return EXIT_FAILURE;
+    }
+    HostArray* testArray = createdArray(elements);
+    uint32_t correctResult = reduceCpu<uint32_t>(testArray->data(), elements);
+
+    auto astart_time = std::chrono::steady_clock::now();
+    int server = connectServer(socketPath);
+    if(server < 0)
+    {
+        delete(testArray);
+        return EXIT_FAILURE;
+    }
+    ServerRequest request = {SERVER_MAGIC, SERVER_SUM, elements};
+    ServerResponse response = {SERVER_STATUS_BAD_REQUEST, 0, 0};
+    //a refused request is answered right after the header, the response is read even if sending the data fails
+    if(writeFully(server, &request, sizeof(request)))
+    {
+        writeFully(server, testArray->data(), elements * sizeof(DATA_TYPE));
+    }
+    bool answered = readFully(server, &response, sizeof(response));
+    close(server);
+    auto aend_time = std::chrono::steady_clock::now();
+    delete(testArray);
+    if(!answered || response.status != SERVER_STATUS_OK)
+    {
+        std::cerr << "request failed, status " << (answered ? static_cast<int>(response.status) : -1) << "\n";
+        return EXIT_FAILURE;
+    }
+    if(correctResult != response.result){std::cout << "!" << response.result << "!" << correctResult << "!" << "\n";std::exit(-69);}
+    printf("%zu elements: sum %u, %llu mus round trip, %llu mus on the server\n", elements, response.result,
+           static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count()),
+           static_cast<unsigned long long>(response.deviceTime));
+    return 0;
+}
+int stopServer(const std::string& socketPath)
+{
+    int server = connectServer(socketPath);
+    if(server < 0)
+    {
+        return EXIT_FAILURE;
+    }
+    ServerRequest request = {SERVER_MAGIC, SERVER_SHUTDOWN, 0};
+    ServerResponse response = {1, 0, 0};
+    bool stopped = writeFully(server, &request, sizeof(request)) && readFully(server, &response, sizeof(response)) && response.status == 0;
+    close(server);
+    return stopped ? 0 : EXIT_FAILURE;
+}
+int connectServer(const std::string& socketPath)
+{
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server < 0 || connect(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        std::perror("connect");
+        if(server >= 0)
+        {
+            close(server);
+        }
+        return -1;
+    }
+    return server;
+}
+bool readFully(int socket, void* buffer, size_t bytes)
+{
+    char* position = static_cast<char*>(buffer);
+    while(bytes > 0)
+    {
+        ssize_t received = recv(socket, position, bytes, 0);
+        if(received <= 0)
+        {
+            return false;
+        }
+        position += received;
+        bytes -= received;
+    }
+    return true;
+}
+bool writeFully(int socket, const void* buffer, size_t bytes)
+{
+    const char* position = static_cast<const char*>(buffer);
+    while(bytes > 0)
+    {
+        //a client that hung up must not kill the server with SIGPIPE
+        ssize_t sent = send(socket, position, bytes, MSG_NOSIGNAL);
+        if(sent <= 0)
+        {
+            return false;
+        }
+        position += sent;
+        bytes -= sent;
+    }
+    return true;
+}
+int testHost()
+{
+    cl::Platform platformToUse;
+    cl::Device deviceToUse;
+    std::vector<cl::Device> devicesToUse;
+    selectDevice(platformToUse, deviceToUse, devicesToUse);
+    cl::Context context(devicesToUse);
+    cl::CommandQueue commandQueue(context, deviceToUse, CL_QUEUE_PROFILING_ENABLE);
+    std::string subgroupOptions = subgroupBuildOptions(deviceToUse);
+    std::string vectorOptions = vectorWidthBuildOptions(deviceToUse);
+    std::string unrolledTreeOptions = unrolledTreeBuildOptions(deviceToUse);
+    std::string globalAtomicOptions = globalAtomicBuildOptions(deviceToUse);
+    size_t persistentGroups = deviceToUse.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * PERSISTENT_GROUPS_PER_CU;
+    //default on-device queue for the kernels that enqueue their own passes, nullptr before OpenCL 2.0
+    cl_command_queue deviceQueue = createDeviceQueue(context, deviceToUse);
+
+    std::vector<Variant> variants = {
+        {"SingleCore CPU", "singleCPU", false, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test1SingleCoreCPU(&correctResult, arr->data(), size); }, true, true},
+        {"MultiCore CPU", "multiCPU", false, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test2MultiCoreCPU(correctResult, arr->data(), size); }, true, true},
+        //switches to prefetching non-temporal loads above the LLC size, SingleCore CPU is the plain path
+        {"LargeArray CPU", "largeArrayCPU", false, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test22LargeArrayCPU(correctResult, arr->data(), size); }, true, true},
+#ifdef HAVE_PARALLEL_STL
+        {"std::reduce par", "stdReduce", false, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test19StdReduce(correctResult, arr->data(), size); }, true, true},
+#endif
+#ifdef HAVE_OPENMP
+        {"OpenMP", "OpenMP", false, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test20OpenMP(correctResult, arr->data(), size); }, true, true},
+#endif
+#ifdef HAVE_TBB
+        {"oneTBB", "oneTBB", false, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test21TBB(correctResult, arr->data(), size); }, true, true},
+#endif
+        {"Dournac", "Dournac", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test3Dournac(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+        {"Catanzaro", "Catanzaro", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test4Catanzaro(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+        {"-Divergence", "Divergence", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test5Divergence(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+        {"Loop unrolling", "Loop", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test6LoopUnrolling(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+        {"ProducerConsumer", "ProCon", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test7ProducerConsumer(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+        {"Coalesced", "Coalesced", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test8Coalesced(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+        {"Subgroups", "Subgroups", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test9Subgroups(correctResult, arr, size, context, commandQueue, devicesToUse, subgroupOptions); }, !subgroupOptions.empty()},
+        {"Vector loads", "VectorLoads", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test10VectorLoads(correctResult, arr, size, context, commandQueue, devicesToUse, vectorOptions); }},
+        {"Tail split", "TailSplit", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test11TailSplit(correctResult, arr, size, context, commandQueue, devicesToUse); }, true, true},
+        {"Unrolled tree", "UnrolledTree", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test12UnrolledTree(correctResult, arr, size, context, commandQueue, devicesToUse, unrolledTreeOptions); }},
+        {"Global atomic", "GlobalAtomic", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test13GlobalAtomic(correctResult, arr, size, context, commandQueue, devicesToUse, globalAtomicOptions); }, true, true},
+        {"ProCon interleaved", "ProConInterleaved", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test15ProConInterleaved(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+        {"Async prefetch", "AsyncPrefetch", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test16AsyncPrefetch(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+        {"Persistent", "Persistent", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test17PersistentThreads(correctResult, arr, size, context, commandQueue, devicesToUse, persistentGroups); }},
+        {"Device enqueue", "DeviceEnqueue", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test18DeviceEnqueue(correctResult, arr, size, context, commandQueue, devicesToUse, deviceQueue != nullptr); }},
+        {"Incremental", "Incremental", true, [&](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test23Incremental(correctResult, arr, size, context, commandQueue, devicesToUse); }},
+    };
+    //one column per accumulator count of the ILP kernel
+    for(int accumulators : ACCUMULATOR_SWEEP)
+    {
+        std::string options = "-DACCUMULATORS=" + std::to_string(accumulators);
+        variants.push_back({"ILP K=" + std::to_string(accumulators), "ILP" + std::to_string(accumulators), true,
+            [&, options](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test14MultiAccumulator(correctResult, arr, size, context, commandQueue, devicesToUse, options); }});
+    }
+    //one column per prefetch distance of the large-array CPU path, the plain column uses CPU_PREFETCH_DISTANCE
+    for(size_t distance : PREFETCH_DISTANCE_SWEEP)
+    {
+        variants.push_back({"LargeArray D=" + std::to_string(distance), "largeArrayCPU" + std::to_string(distance), false,
+            [distance](uint32_t& correctResult, HostArray* arr, size_t size)
+            { return test22LargeArrayCPU(correctResult, arr->data(), size, distance); }, true, true});
+    }
+
+    BandwidthPeaks peaks = measureBandwidthPeaks(context, commandQueue, deviceToUse, devicesToUse);
+    std::cout << "LLC: " << lastLevelCacheBytes() / 1024 << " KiB, large-array CPU path above "
+              << lastLevelCacheBytes() / sizeof(uint32_t) << " elements\n";
+    std::cout << "STREAM peaks [GB/s]: host read " << peaks.hostRead << ", host copy " << peaks.hostCopy
+              << ", device read " << peaks.deviceRead << ", device copy " << peaks.deviceCopy << "\n";
+    //best GB/s of every variant without startup, for the roofline summary
+    std::vector<double> bestBandwidth(variants.size(), 0.0);
+    std::vector<size_t> bestBandwidthSize(variants.size(), 0);
+
+    std::ofstream* currentFile;
+    std::ofstream withoutStartup(RESULTS_PATH("withoutStartup.csv"));
+    std::ofstream withStartup(RESULTS_PATH("withStartup.csv"));
+    std::ofstream statistics(RESULTS_PATH("statistics.csv"));
+    std::ofstream phasesFile(RESULTS_PATH("phases.csv"));
+    std::ofstream results(RESULTS_PATH("results.jsonl"));
+
+    //raw samples of every measured run, one line per size
+    std::vector<std::ofstream> deviations(variants.size());
+    std::vector<std::ofstream> deviationsStartup(variants.size());
+    for(size_t h = 0; h < variants.size(); h++)
+    {
+        deviations[h] = std::ofstream(RESULTS_PATH("singleResults/") + variants[h].fileName + ".csv");
+        deviations[h] << "Elements, Results\n";
+        if(variants[h].isDevice)
+        {
+            deviationsStartup[h] = std::ofstream(RESULTS_PATH("singleResults/") + variants[h].fileName + "Startup.csv");
+            deviationsStartup[h] << "Elements, Results\n";
+        }
+    }
+    statistics << "Elements, Variant, Startup, Runs, Min, Median, Mean, StdDev, P90, P99, CI95 low, CI95 high, GB/s, Elements/s, % of peak\n";
+    //median device time per phase in ns, followed by the kernel and copy of every pass
+    phasesFile << "Elements, Variant, Startup, Upload, Kernels, Copies, Readback, Passes, Pass kernel/copy...\n";
+    //the first record describes the whole run, every cell follows as a result record
+    results << "{\"type\": \"metadata\""
+            << ", \"timestamp\": " << std::time(nullptr)
+            << ", \"commit\": " << jsonString(GIT_COMMIT)
+            << ", \"platform\": " << jsonString(platformToUse.getInfo<CL_PLATFORM_NAME>().c_str())
+            << ", \"platform_version\": " << jsonString(platformToUse.getInfo<CL_PLATFORM_VERSION>().c_str())
+            << ", \"device\": " << jsonString(deviceToUse.getInfo<CL_DEVICE_NAME>().c_str())
+            << ", \"device_version\": " << jsonString(deviceToUse.getInfo<CL_DEVICE_VERSION>().c_str())
+            << ", \"driver\": " << jsonString(deviceToUse.getInfo<CL_DRIVER_VERSION>().c_str())
+            << ", \"seed\": " << inputSeed
+            << ", \"device_input\": " << deviceResidentInput
+            << ", \"kernel_build_options\": " << jsonString(kernelBuildOptions)
+            //the per-device geometry of the variants that add their own defines
+            << ", \"subgroup_build_options\": " << jsonString(subgroupOptions)
+            << ", \"vector_build_options\": " << jsonString(vectorOptions)
+            << ", \"unrolled_tree_build_options\": " << jsonString(unrolledTreeOptions)
+            << ", \"global_atomic_build_options\": " << jsonString(globalAtomicOptions)
+            << ", \"compiler\": " << jsonString(__VERSION__)
+            << ", \"local_size\": " << LOCAL_SIZE
+            << ", \"work_group_count\": " << WORK_GROUP_COUNT
+            << ", \"warmup_runs\": " << WARMUP_RUNS
+            << ", \"min_runs\": " << MIN_RUNS_PER_CELL
+            << ", \"host_read_gbs\": " << peaks.hostRead
+            << ", \"device_read_gbs\": " << peaks.deviceRead << "}\n";
+
+    currentFile = &withoutStartup;
+
+    for(int g = 0; g < 2; g++)
+    {
+        if(measureSetupTime)
+        {
+            std::cout << "--- Measurements with startup of kernel ---\n";
+        }
+        std::cout << "median of at least " << MIN_RUNS_PER_CELL << " runs after " << WARMUP_RUNS << " warm-up runs [mus]\n";
+        std::printf("%10s|", "Elements");
+        (*currentFile) << "Elements";
+        for(const Variant& variant : variants)
+        {
+            std::printf("%*s|", variantColumnWidth(variant), variant.name.c_str());
+            (*currentFile) << ", " << variant.name;
+        }
+        std::cout << "\n";
+        (*currentFile) << "\n";
 
-            //6
-            for (int j = 0; j < AVERAGE_OUT_OF; j++)
+        for (int i = 0; i <= MAX_DATA_SIZE_SHIFTS; i++)
+        {
+            //the last size is ragged, only variants that handle any size take part in it
+            bool ragged = i == MAX_DATA_SIZE_SHIFTS;
+            size_t elementCount = ragged ? LOCAL_SIZE * WORK_GROUP_COUNT * (1 << (MAX_DATA_SIZE_SHIFTS / 2)) + RAGGED_SIZE_OFFSET : LOCAL_SIZE * WORK_GROUP_COUNT * (1 << i);
+            (*currentFile) << elementCount;
+            printf("%10llu|", static_cast<unsigned long long>(elementCount));
+            HostArray* testArray = createdArray(elementCount);
+            uint32_t correctResult = 0U;
+            if(deviceResidentInput)
             {
-                uint64_t temp = test6LoopUnrolling(correctResult, testArray, elementCount, context, commandQueue, devicesToUse);
-                avg += temp;
-                if(!measureSetupTime)
-                {
-                    deviations[5] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
-                else
-                {
-                    deviationsStartup[3] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
-                }
+                //the CPU columns still reduce the host copy, which is the reference for the device sums
+                residentInput = generateDeviceInput(context, commandQueue, deviceToUse, devicesToUse, elementCount, inputSeed);
             }
-            printf("%15llu|", avg / AVERAGE_OUT_OF);
-            (*currentFile) << avg / AVERAGE_OUT_OF << ", ";
-            avg = 0;
 
-            //7
-            for (int j = 0; j < AVERAGE_OUT_OF; j++)
+            for(size_t h = 0; h < variants.size(); h++)
             {
-                uint64_t temp = test7ProducerConsumer(correctResult, testArray, elementCount, context, commandQueue,
-                                             devicesToUse);
-                avg += temp;
-                if(!measureSetupTime)
+                if(!variants[h].enabled || (ragged && !variants[h].anySize))
                 {
-                    deviations[6] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
+                    printf("%*s|", variantColumnWidth(variants[h]), "n/a");
+                    (*currentFile) << ", ";
+                    continue;
                 }
-                else
+                std::vector<PhaseTimes> phases;
+                RunStatistics stats = measureVariant([&]()
                 {
-                    deviationsStartup[4] << temp << (j == (AVERAGE_OUT_OF - 1) ? "\n" : ", ");
+                    uint64_t time = variants[h].run(correctResult, testArray, elementCount);
+                    phases.push_back(lastPhases);
+                    return time;
+                });
+                if(variants[h].isDevice)
+                {
+                    //warm-up runs are not part of the samples
+                    phases.erase(phases.begin(), phases.begin() + WARMUP_RUNS);
+                    writePhases(phasesFile, elementCount, variants[h], phases);
                 }
-            }
-            printf("%16llu|", avg / AVERAGE_OUT_OF);
-            (*currentFile) << avg / AVERAGE_OUT_OF << ", ";
-            avg = 0;
 
-            //8
-            for (int j = 0; j < AVERAGE_OUT_OF; j++)
-            {
-                uint64_t temp = test8Coalesced(correctResult, testArray, elementCount, context, commandQueue, devicesToUse);
-                avg += temp;
-                if(!measureSetupTime)
+                std::ofstream& samplesFile = measureSetupTime ? deviationsStartup[h] : deviations[h];
+                if(samplesFile.is_open())
+                {
+                    samplesFile << elementCount;
+                    for(uint64_t sample : stats.samples)
+                    {
+                        samplesFile << ", " << sample;
+                    }
+                    samplesFile << "\n";
+                }
+                double bandwidth = bandwidthGBs(elementCount, stats.median);
+                double elementsPerSecond = stats.median > 0 ? elementCount * 1e6 / stats.median : 0.0;
+                double peak = variants[h].isDevice ? peaks.deviceRead : peaks.hostRead;
+                statistics << elementCount << ", " << variants[h].name << ", " << measureSetupTime << ", "
+                           << stats.samples.size() << ", " << stats.min << ", " << stats.median << ", "
+                           << stats.mean << ", " << stats.stddev << ", " << stats.p90 << ", " << stats.p99 << ", "
+                           << stats.ciLow << ", " << stats.ciHigh << ", "
+                           << bandwidth << ", " << elementsPerSecond << ", " << (peak > 0.0 ? 100.0 * bandwidth / peak : 0.0) << "\n";
+                results << "{\"type\": \"result\", \"variant\": " << jsonString(variants[h].name)
+                        << ", \"elements\": " << elementCount << ", \"startup\": " << measureSetupTime
+                        << ", \"runs\": " << stats.samples.size() << ", \"min\": " << stats.min
+                        << ", \"median\": " << stats.median << ", \"mean\": " << stats.mean
+                        << ", \"stddev\": " << stats.stddev << ", \"p90\": " << stats.p90 << ", \"p99\": " << stats.p99
+                        << ", \"ci_low\": " << stats.ciLow << ", \"ci_high\": " << stats.ciHigh
+                        << ", \"gbs\": " << bandwidth << ", \"samples\": [";
+                for(size_t k = 0; k < stats.samples.size(); k++)
                 {
-                    deviations[7] << temp;
+                    results << (k ? ", " : "") << stats.samples[k];
                 }
-                else
+                results << "]}\n";
+                results.flush();
+                if(!measureSetupTime && bandwidth > bestBandwidth[h])
                 {
-                    deviationsStartup[5] << temp;
+                    bestBandwidth[h] = bandwidth;
+                    bestBandwidthSize[h] = elementCount;
                 }
+
+                printf("%*llu|", variantColumnWidth(variants[h]), static_cast<unsigned long long>(stats.median));
+                (*currentFile) << ", " << stats.median;
             }
-            printf("%10llu|", avg / AVERAGE_OUT_OF);
-            (*currentFile) << avg / AVERAGE_OUT_OF;
-            avg = 0;
 
             (*currentFile) << "\n";
             std::cout << "\n";
             delete (testArray);
+            residentInput = cl::Buffer();
         }
         (*currentFile).close();
         measureSetupTime = 1;
         currentFile = &withStartup;
     }
-    for(int h = 0; h < 8; h++)
+    for(size_t h = 0; h < variants.size(); h++)
     {
         deviations[h].close();
+        deviationsStartup[h].close();
     }
-    for(int h = 0; h < 6; h++)
+    statistics.close();
+    phasesFile.close();
+    results.close();
+
+    //a sum does SUM_ARITHMETIC_INTENSITY ops per byte, far left of any ridge point, so the memory roof is the limit
+    std::ofstream roofline(RESULTS_PATH("roofline.csv"));
+    roofline << "Variant, Best GB/s, At elements, Peak GB/s, % of peak, Attained Gop/s, Roof Gop/s\n";
+    std::cout << "--- Roofline (memory roof, " << SUM_ARITHMETIC_INTENSITY << " op/byte) ---\n";
+    std::printf("%16s|%10s|%12s|%10s|%10s|%10s|\n", "Variant", "GB/s", "Elements", "Peak GB/s", "% of peak", "Gop/s");
+    for(size_t h = 0; h < variants.size(); h++)
     {
-        deviationsStartup[h].close();
+        double peak = variants[h].isDevice ? peaks.deviceRead : peaks.hostRead;
+        double percent = peak > 0.0 ? 100.0 * bestBandwidth[h] / peak : 0.0;
+        std::printf("%16s|%10.2f|%12llu|%10.2f|%10.1f|%10.2f|\n", variants[h].name.c_str(), bestBandwidth[h],
+                    static_cast<unsigned long long>(bestBandwidthSize[h]), peak, percent, bestBandwidth[h] * SUM_ARITHMETIC_INTENSITY);
+        roofline << variants[h].name << ", " << bestBandwidth[h] << ", " << bestBandwidthSize[h] << ", " << peak << ", "
+                 << percent << ", " << bestBandwidth[h] * SUM_ARITHMETIC_INTENSITY << ", " << peak * SUM_ARITHMETIC_INTENSITY << "\n";
+    }
+    roofline.close();
+    if(deviceQueue != nullptr)
+    {
+        clReleaseCommandQueue(deviceQueue);
     }
     return 0;
 }
-uint64_t test1SingleCoreCPU(uint32_t* correctResult, std::vector<uint32_t>* arr, size_t size)
+int variantColumnWidth(const Variant& variant)
 {
-    auto astart_time = std::chrono::steady_clock::now();
-    uint32_t sum = 0;
-    for(ssize_t i = 0; i < size; i++)
+    return std::max(10, static_cast<int>(variant.name.size()));
+}
+RunStatistics measureVariant(const std::function<uint64_t()>& run)
+{
+    RunStatistics stats;
+    //first runs pay for the program build cache, page faults and the clock ramp-up
+    for(int j = 0; j < WARMUP_RUNS; j++)
     {
-        sum = sum + (*arr)[i];
+        run();
     }
-    *correctResult = sum;
+    for(int j = 0; j < MIN_RUNS_PER_CELL; j++)
+    {
+        stats.samples.push_back(run());
+    }
+    computeStatistics(stats);
+    //keep sampling until the confidence interval of the median is tight enough
+    while(stats.samples.size() < MAX_RUNS_PER_CELL
+          && stats.median > 0
+          && (stats.ciHigh - stats.ciLow) / 2.0 > TARGET_PRECISION * stats.median)
+    {
+        for(int j = 0; j < PRECISION_BATCH; j++)
+        {
+            stats.samples.push_back(run());
+        }
+        computeStatistics(stats);
+    }
+    return stats;
+}
+void computeStatistics(RunStatistics& stats)
+{
+    std::vector<uint64_t> sorted(stats.samples);
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+
+    //nearest-rank percentiles
+    auto percentile = [&](double p) { return sorted[std::max<size_t>(1, static_cast<size_t>(std::ceil(p * n))) - 1]; };
+    stats.min = sorted.front();
+    stats.median = percentile(0.5);
+    stats.p90 = percentile(0.9);
+    stats.p99 = percentile(0.99);
+
+    double sum = 0.0;
+    for(uint64_t sample : sorted)
+    {
+        sum += sample;
+    }
+    stats.mean = sum / n;
+    double squares = 0.0;
+    for(uint64_t sample : sorted)
+    {
+        squares += (sample - stats.mean) * (sample - stats.mean);
+    }
+    stats.stddev = n > 1 ? std::sqrt(squares / (n - 1)) : 0.0;
+
+    //percentile bootstrap of the median, fixed seed so reruns on the same samples agree
+    std::mt19937_64 generator(BOOTSTRAP_SEED);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+    std::vector<uint64_t> resample(n);
+    std::vector<uint64_t> medians(BOOTSTRAP_RESAMPLES);
+    for(int r = 0; r < BOOTSTRAP_RESAMPLES; r++)
+    {
+        for(size_t k = 0; k < n; k++)
+        {
+            resample[k] = sorted[pick(generator)];
+        }
+        std::nth_element(resample.begin(), resample.begin() + (n - 1) / 2, resample.end());
+        medians[r] = resample[(n - 1) / 2];
+    }
+    std::sort(medians.begin(), medians.end());
+    stats.ciLow = medians[static_cast<size_t>(0.025 * (BOOTSTRAP_RESAMPLES - 1))];
+    stats.ciHigh = medians[static_cast<size_t>(0.975 * (BOOTSTRAP_RESAMPLES - 1))];
+}
+uint64_t medianOf(std::vector<uint64_t> values)
+{
+    if(values.empty())
+    {
+        return 0;
+    }
+    std::nth_element(values.begin(), values.begin() + (values.size() - 1) / 2, values.end());
+    return values[(values.size() - 1) / 2];
+}
+uint64_t eventDuration(const cl::Event& event)
+{
+    //commands that were rejected, like the zero sized copy after the last pass, never get an event
+    if(event() == nullptr)
+    {
+        return 0;
+    }
+    return event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+}
+void recordPhases(const cl::Event& upload, const std::vector<cl::Event>& kernels, const std::vector<cl::Event>& copies, const cl::Event& readback)
+{
+    lastPhases = PhaseTimes();
+    lastPhases.upload = eventDuration(upload);
+    for(const cl::Event& kernel : kernels)
+    {
+        lastPhases.kernels.push_back(eventDuration(kernel));
+    }
+    for(const cl::Event& copy : copies)
+    {
+        lastPhases.copies.push_back(eventDuration(copy));
+    }
+    lastPhases.readback = eventDuration(readback);
+}
+void writePhases(std::ofstream& file, size_t elementCount, const Variant& variant, std::vector<PhaseTimes>& phases)
+{
+    std::vector<uint64_t> uploads, kernelTotals, copyTotals, readbacks;
+    for(const PhaseTimes& phase : phases)
+    {
+        uploads.push_back(phase.upload);
+        kernelTotals.push_back(std::accumulate(phase.kernels.begin(), phase.kernels.end(), uint64_t(0)));
+        copyTotals.push_back(std::accumulate(phase.copies.begin(), phase.copies.end(), uint64_t(0)));
+        readbacks.push_back(phase.readback);
+    }
+    size_t passes = phases.empty() ? 0 : phases.front().kernels.size();
+    file << elementCount << ", " << variant.name << ", " << measureSetupTime << ", "
+         << medianOf(uploads) << ", " << medianOf(kernelTotals) << ", " << medianOf(copyTotals) << ", "
+         << medianOf(readbacks) << ", " << passes;
+    for(size_t pass = 0; pass < passes; pass++)
+    {
+        std::vector<uint64_t> kernel, copy;
+        for(const PhaseTimes& phase : phases)
+        {
+            kernel.push_back(phase.kernels[pass]);
+            copy.push_back(pass < phase.copies.size() ? phase.copies[pass] : 0);
+        }
+        file << ", " << medianOf(kernel) << ", " << medianOf(copy);
+    }
+    file << "\n";
+}
+double bandwidthGBs(size_t elementCount, uint64_t microseconds)
+{
+    //bytes per ns is GB/s
+    return microseconds > 0 ? elementCount * sizeof(DATA_TYPE) / (microseconds * 1000.0) : 0.0;
+}
+BandwidthPeaks measureBandwidthPeaks(cl::Context context, cl::CommandQueue commandQueue, cl::Device device, std::vector<cl::Device>& devicesToUse)
+{
+    BandwidthPeaks peaks;
+    cl_int err;
+    size_t bytes = STREAM_ELEMENTS * sizeof(DATA_TYPE);
+    std::vector<uint32_t> source(STREAM_ELEMENTS, 1U);
+    std::vector<uint32_t> destination(STREAM_ELEMENTS, 0U);
+
+    //host, all hardware threads on disjoint chunks
+    size_t num_threads = std::max(1U, std::thread::hardware_concurrency());
+    size_t chunk_size = STREAM_ELEMENTS / num_threads;
+    std::vector<uint32_t> sinks(num_threads);
+    for(int repeat = 0; repeat < STREAM_REPEATS; repeat++)
+    {
+        for(int copy = 0; copy < 2; copy++)
+        {
+            std::vector<std::thread> threads;
+            auto astart_time = std::chrono::steady_clock::now();
+            for(size_t i = 0; i < num_threads; i++)
+            {
+                size_t start = i * chunk_size;
+                size_t end = (i == num_threads - 1) ? STREAM_ELEMENTS : start + chunk_size;
+                threads.emplace_back([&, start, end, i]()
+                {
+                    if(copy)
+                    {
+                        std::memcpy(destination.data() + start, source.data() + start, (end - start) * sizeof(uint32_t));
+                    }
+                    else
+                    {
+                        sinks[i] = std::accumulate(source.begin() + start, source.begin() + end, 0U);
+                    }
+                });
+            }
+            for(std::thread& thread : threads)
+            {
+                thread.join();
+            }
+            auto aend_time = std::chrono::steady_clock::now();
+            double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(aend_time - astart_time).count();
+            double& peak = copy ? peaks.hostCopy : peaks.hostRead;
+            peak = std::max(peak, (copy ? 2 : 1) * bytes / ns);
+        }
+    }
+
+    //device, kernel time from the profiling events
+    std::ifstream sourceFile(KERNEL_PATH("streamBenchmark.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources programSource(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, programSource);
+    program.build(devicesToUse);
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel readKernel (program, "streamRead", &err); CHECK_ERROR(err);
+    cl::Kernel copyKernel (program, "streamCopy", &err); CHECK_ERROR(err);
+
+    size_t globalSize = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * STREAM_GROUPS_PER_CU * LOCAL_SIZE;
+    cl_int vectorCount = STREAM_ELEMENTS / 4;
+    cl::Buffer input = cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, source.data(), &err); CHECK_ERROR(err);
+    cl::Buffer output = cl::Buffer(context, CL_MEM_READ_WRITE, bytes, nullptr, &err); CHECK_ERROR(err);
+    err = readKernel.setArg(0, input); CHECK_ERROR(err);
+    err = readKernel.setArg(1, sizeof(cl_int), &vectorCount); CHECK_ERROR(err);
+    err = readKernel.setArg(2, output); CHECK_ERROR(err);
+    err = copyKernel.setArg(0, input); CHECK_ERROR(err);
+    err = copyKernel.setArg(1, sizeof(cl_int), &vectorCount); CHECK_ERROR(err);
+    err = copyKernel.setArg(2, output); CHECK_ERROR(err);
+    for(int repeat = 0; repeat < STREAM_REPEATS; repeat++)
+    {
+        cl::Event readEvent;
+        cl::Event copyEvent;
+        err = commandQueue.enqueueNDRangeKernel(readKernel, cl::NullRange, cl::NDRange(globalSize), cl::NDRange(LOCAL_SIZE), nullptr, &readEvent); CHECK_ERROR(err);
+        err = commandQueue.enqueueNDRangeKernel(copyKernel, cl::NullRange, cl::NDRange(globalSize), cl::NDRange(LOCAL_SIZE), nullptr, &copyEvent); CHECK_ERROR(err);
+        commandQueue.finish();
+        peaks.deviceRead = std::max(peaks.deviceRead, static_cast<double>(bytes) / eventDuration(readEvent));
+        peaks.deviceCopy = std::max(peaks.deviceCopy, 2.0 * bytes / eventDuration(copyEvent));
+    }
+    return peaks;
+}
+cl::Buffer generateDeviceInput(cl::Context context, cl::CommandQueue commandQueue, cl::Device device, std::vector<cl::Device>& devicesToUse, size_t size, uint64_t seed)
+{
+    cl_int err;
+    std::ifstream sourceFile(KERNEL_PATH("inputGenerator.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources programSource(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, programSource);
+    program.build(devicesToUse);
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "generate", &err); CHECK_ERROR(err);
+
+    cl::Buffer output = cl::Buffer(context, CL_MEM_READ_WRITE, size * sizeof(DATA_TYPE), nullptr, &err); CHECK_ERROR(err);
+    cl_ulong kernelSeed = seed;
+    cl_ulong kernelSize = size;
+    err = kernel.setArg(0, output); CHECK_ERROR(err);
+    err = kernel.setArg(1, sizeof(cl_ulong), &kernelSeed); CHECK_ERROR(err);
+    err = kernel.setArg(2, sizeof(cl_ulong), &kernelSize); CHECK_ERROR(err);
+    size_t globalSize = std::min<size_t>(size, device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * STREAM_GROUPS_PER_CU * LOCAL_SIZE);
+    err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(globalSize), cl::NullRange); CHECK_ERROR(err);
+    commandQueue.finish();
+    return output;
+}
+cl_int uploadInput(cl::CommandQueue& commandQueue, cl::Buffer& target, HostArray* arr, size_t sizeData, cl::Event* uploadEvent)
+{
+    if(residentInput() == nullptr)
+    {
+        return commandQueue.enqueueWriteBuffer(target, CL_TRUE, 0, sizeData, arr->data(), nullptr, uploadEvent);
+    }
+    //the kernels overwrite their input, so every run starts from a device-side copy of the generated data
+    cl_int err = commandQueue.enqueueCopyBuffer(residentInput, target, 0, 0, sizeData, nullptr, uploadEvent);
+    if(err == CL_SUCCESS)
+    {
+        err = uploadEvent->wait();
+    }
+    return err;
+}
+std::string jsonString(const std::string& text)
+{
+    std::string quoted = "\"";
+    for(char c : text)
+    {
+        if(c == '"' || c == '\\')
+        {
+            quoted += '\\';
+            quoted += c;
+        }
+        else if(static_cast<unsigned char>(c) < 0x20)
+        {
+            quoted += ' ';
+        }
+        else
+        {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+bool parseResultRecord(const std::string& line, ResultRecord& record)
+{
+    //only the flat objects written by testHost: string, number and number array values
+    size_t pos = 0;
+    auto skipSpace = [&]() { while(pos < line.size() && std::isspace(static_cast<unsigned char>(line[pos]))) pos++; };
+    auto parseString = [&](std::string& out) -> bool
+    {
+        if(line[pos] != '"') return false;
+        for(pos++; pos < line.size() && line[pos] != '"'; pos++)
+        {
+            if(line[pos] == '\\') pos++;
+            out += line[pos];
+        }
+        return pos++ < line.size();
+    };
+    auto parseNumber = [&](double& out) -> bool
+    {
+        char* end;
+        out = std::strtod(line.c_str() + pos, &end);
+        if(end == line.c_str() + pos) return false;
+        pos = end - line.c_str();
+        return true;
+    };
+    skipSpace();
+    if(pos >= line.size() || line[pos++] != '{') return false;
+    skipSpace();
+    while(pos < line.size() && line[pos] != '}')
+    {
+        std::string key;
+        skipSpace();
+        if(!parseString(key)) return false;
+        skipSpace();
+        if(line[pos++] != ':') return false;
+        skipSpace();
+        if(line[pos] == '"')
+        {
+            if(!parseString(record.strings[key])) return false;
+        }
+        else if(line[pos] == '[')
+        {
+            std::vector<double>& values = record.arrays[key];
+            for(pos++, skipSpace(); line[pos] != ']'; skipSpace())
+            {
+                double value;
+                if(!parseNumber(value)) return false;
+                values.push_back(value);
+                skipSpace();
+                if(line[pos] == ',') pos++;
+            }
+            pos++;
+        }
+        else if(!parseNumber(record.numbers[key]))
+        {
+            return false;
+        }
+        skipSpace();
+        if(line[pos] == ',') pos++;
+        skipSpace();
+    }
+    return pos < line.size();
+}
+std::vector<ResultRecord> loadResults(const char* path)
+{
+    std::vector<ResultRecord> records;
+    std::ifstream file(path);
+    if(!file)
+    {
+        std::cerr << "cannot open " << path << "\n";
+        std::exit(EXIT_FAILURE);
+    }
+    std::string line;
+    for(int lineNumber = 1; std::getline(file, line); lineNumber++)
+    {
+        if(line.empty()) continue;
+        ResultRecord record;
+        if(!parseResultRecord(line, record))
+        {
+            std::cerr << path << ":" << lineNumber << ": malformed record\n";
+            std::exit(EXIT_FAILURE);
+        }
+        records.push_back(record);
+    }
+    return records;
+}
+double mannWhitneySlowerPValue(const std::vector<double>& baseline, const std::vector<double>& current)
+{
+    //one sided Mann-Whitney U, normal approximation with tie correction: P(current is not slower)
+    size_t n1 = baseline.size();
+    size_t n2 = current.size();
+    if(n1 == 0 || n2 == 0)
+    {
+        return 1.0;
+    }
+    std::vector<std::pair<double, int>> combined;
+    for(double value : baseline) combined.emplace_back(value, 0);
+    for(double value : current) combined.emplace_back(value, 1);
+    std::sort(combined.begin(), combined.end());
+    double rankSumCurrent = 0.0;
+    double tieTerm = 0.0;
+    for(size_t i = 0; i < combined.size();)
+    {
+        size_t j = i;
+        while(j < combined.size() && combined[j].first == combined[i].first) j++;
+        double averageRank = (i + 1 + j) / 2.0;
+        for(size_t k = i; k < j; k++)
+        {
+            if(combined[k].second) rankSumCurrent += averageRank;
+        }
+        double ties = j - i;
+        tieTerm += ties * ties * ties - ties;
+        i = j;
+    }
+    double n = n1 + n2;
+    double u = rankSumCurrent - n2 * (n2 + 1) / 2.0;
+    double variance = n1 * n2 / 12.0 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if(variance <= 0.0)
+    {
+        return 1.0;
+    }
+    double z = (u - n1 * n2 / 2.0) / std::sqrt(variance);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+int compareResults(const char* baselinePath, const char* currentPath)
+{
+    std::vector<ResultRecord> baseline = loadResults(baselinePath);
+    std::vector<ResultRecord> current = loadResults(currentPath);
+    auto key = [](const ResultRecord& record)
+    {
+        return record.strings.at("variant") + "|" + std::to_string(static_cast<uint64_t>(record.numbers.at("elements")))
+               + "|" + std::to_string(static_cast<int>(record.numbers.at("startup")));
+    };
+    std::map<std::string, const ResultRecord*> baselineResults;
+    for(const ResultRecord& record : baseline)
+    {
+        if(record.strings.count("type") && record.strings.at("type") == "metadata")
+        {
+            for(const ResultRecord& other : current)
+            {
+                if(other.strings.count("type") && other.strings.at("type") == "metadata")
+                {
+                    for(const char* field : {"device", "driver", "compiler", "kernel_build_options", "subgroup_build_options",
+                                             "vector_build_options", "unrolled_tree_build_options", "global_atomic_build_options"})
+                    {
+                        if(record.strings.count(field) && other.strings.count(field) && record.strings.at(field) != other.strings.at(field))
+                        {
+                            std::cout << "warning: " << field << " differs: \"" << record.strings.at(field)
+                                      << "\" vs \"" << other.strings.at(field) << "\"\n";
+                        }
+                    }
+                    auto commit = [](const ResultRecord& metadata)
+                    {
+                        auto it = metadata.strings.find("commit");
+                        return it != metadata.strings.end() ? it->second : std::string("unknown");
+                    };
+                    std::cout << "baseline commit " << commit(record) << ", current commit " << commit(other) << "\n";
+                }
+            }
+        }
+        else if(record.strings.count("variant"))
+        {
+            baselineResults[key(record)] = &record;
+        }
+    }
+
+    int regressions = 0;
+    std::printf("%16s|%10s|%8s|%12s|%12s|%8s|%10s|\n", "Variant", "Elements", "Startup", "Base median", "Median", "Ratio", "p");
+    for(const ResultRecord& record : current)
+    {
+        if(!record.strings.count("variant"))
+        {
+            continue;
+        }
+        auto match = baselineResults.find(key(record));
+        if(match == baselineResults.end())
+        {
+            continue;
+        }
+        const ResultRecord& base = *match->second;
+        double ratio = base.numbers.at("median") > 0 ? record.numbers.at("median") / base.numbers.at("median") : 1.0;
+        double p = mannWhitneySlowerPValue(base.arrays.count("samples") ? base.arrays.at("samples") : std::vector<double>(),
+                                           record.arrays.count("samples") ? record.arrays.at("samples") : std::vector<double>());
+        bool slower = ratio > 1.0 + REGRESSION_THRESHOLD && p < REGRESSION_P_VALUE;
+        regressions += slower;
+        std::printf("%16s|%10llu|%8d|%12.0f|%12.0f|%8.3f|%10.2g|%s\n", record.strings.at("variant").c_str(),
+                    static_cast<unsigned long long>(record.numbers.at("elements")), static_cast<int>(record.numbers.at("startup")),
+                    base.numbers.at("median"), record.numbers.at("median"), ratio, p, slower ? " SLOWER" : "");
+    }
+    std::cout << regressions << " significant slowdown(s)\n";
+    return regressions ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+uint64_t test1SingleCoreCPU(uint32_t* correctResult, const uint32_t* arr, size_t size)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    uint32_t sum = reduceCpu<uint32_t>(arr, size);
+    *correctResult = sum;
     auto aend_time = std::chrono::steady_clock::now();
     return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
-void test2MultiCoreCPUPartialSum(const std::vector<uint32_t>& arr, size_t start, size_t end, uint32_t& result) {
-    result = std::accumulate(arr.begin() + start, arr.begin() + end, 0);
+void test2MultiCoreCPUPartialSum(const uint32_t* arr, size_t start, size_t end, uint32_t& result) {
+    result = reduceCpu<uint32_t>(arr + start, end - start);
 }
-uint64_t test2MultiCoreCPU(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size)
+uint64_t test2MultiCoreCPU(uint32_t correctResult, const uint32_t* arr, size_t size)
 {
     auto astart_time = std::chrono::steady_clock::now();
     // Number of threads
-    const size_t num_threads = 16;
+    const size_t num_threads = CPU_WORKER_THREADS;
     std::vector<std::thread> threads(num_threads);
     std::vector<uint32_t> results(num_threads, 0);
 
@@ -461,32 +1776,590 @@ uint64_t test2MultiCoreCPU(uint32_t correctResult, std::vector<uint32_t>* arr, s
     for (size_t i = 0; i < num_threads; ++i) {
         size_t start = i * chunk_size;
         size_t end = (i == num_threads - 1) ? size : start + chunk_size;
-        threads[i] = std::thread(test2MultiCoreCPUPartialSum, std::ref((*arr)), start, end, std::ref(results[i]));
+        //same cpu as the thread that first touched this chunk in createdArray
+        threads[i] = std::thread([arr, start, end, i, &results]()
+        {
+            pinWorker(i);
+            test2MultiCoreCPUPartialSum(arr, start, end, results[i]);
+        });
+    }
+
+    // Join threads
+    for (size_t i = 0; i < num_threads; ++i) {
+        threads[i].join();
+    }
+
+    // Calculate final sum
+    uint32_t final_sum = reduceCpu<uint32_t, SumOperator, 1, 1>(results.data(), results.size());
+    auto aend_time = std::chrono::steady_clock::now();
+    if(correctResult != final_sum){exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+uint64_t test22LargeArrayCPU(uint32_t correctResult, const uint32_t* arr, size_t size, size_t prefetchDistance)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    uint32_t final_sum = reduceCpuAuto(arr, size, prefetchDistance);
+    auto aend_time = std::chrono::steady_clock::now();
+    if(correctResult != final_sum){exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+#ifdef HAVE_PARALLEL_STL
+uint64_t test19StdReduce(uint32_t correctResult, const uint32_t* arr, size_t size)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    uint32_t final_sum = std::reduce(std::execution::par_unseq, arr, arr + size, uint32_t(0));
+    auto aend_time = std::chrono::steady_clock::now();
+    if(correctResult != final_sum){exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+#endif
+#ifdef HAVE_OPENMP
+uint64_t test20OpenMP(uint32_t correctResult, const uint32_t* arr, size_t size)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    uint32_t final_sum = 0;
+    const uint32_t* data = arr;
+    #pragma omp parallel for simd reduction(+:final_sum)
+    for(ptrdiff_t i = 0; i < static_cast<ptrdiff_t>(size); i++)
+    {
+        final_sum += data[i];
+    }
+    auto aend_time = std::chrono::steady_clock::now();
+    if(correctResult != final_sum){exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+#endif
+#ifdef HAVE_TBB
+uint64_t test21TBB(uint32_t correctResult, const uint32_t* arr, size_t size)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    const uint32_t* data = arr;
+    uint32_t final_sum = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, size), uint32_t(0),
+        [data](const tbb::blocked_range<size_t>& range, uint32_t partial)
+        {
+            return partial + reduceCpu<uint32_t>(data + range.begin(), range.size());
+        },
+        std::plus<uint32_t>());
+    auto aend_time = std::chrono::steady_clock::now();
+    if(correctResult != final_sum){exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+#endif
+uint64_t test3Dournac(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction1.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    while(countData > 1)
+    //for(int i = 0; i < 2; i++)
+    {
+        err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+        err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+        err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
+        //err = kernel.setArg(4, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        //err = kernel.setArg(5, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+
+        cl::NDRange global(countData);
+        cl::NDRange local(LOCAL_SIZE > countData ? countData : LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
+
+        countData = countData / LOCAL_SIZE;
+        sizeData = countData * sizeof(DATA_TYPE);
+
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
+    }
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
+
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+uint64_t test4Catanzaro(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction2.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    while(countData > 1)
+        //for(int i = 0; i < 2; i++)
+    {
+        err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+        err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+        err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
+        //err = kernel.setArg(4, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        //err = kernel.setArg(5, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+
+        cl::NDRange global(countData);
+        cl::NDRange local(LOCAL_SIZE > countData ? countData : LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
+
+        countData = countData / LOCAL_SIZE;
+        sizeData = countData * sizeof(DATA_TYPE);
+
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
+    }
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
+
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+uint64_t test5Divergence(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction3.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    while(countData > 1)
+        //for(int i = 0; i < 2; i++)
+    {
+        err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+        err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+        err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
+        //err = kernel.setArg(4, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        //err = kernel.setArg(5, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+
+        cl::NDRange global(countData);
+        cl::NDRange local(LOCAL_SIZE > countData ? countData : LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
+
+        countData = countData / LOCAL_SIZE;
+        sizeData = countData * sizeof(DATA_TYPE);
+
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
+    }
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
+
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+uint64_t test6LoopUnrolling(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction4.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    //while(countData > 1)
+    for(int i = 0; i < 2; i++)
+    {
+        err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+        err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+        err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
+        //err = kernel.setArg(4, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        //err = kernel.setArg(5, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+
+        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        cl::NDRange local(LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
+
+        countData = WORK_GROUP_COUNT;
+        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
+
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
+    }
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
+
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+uint64_t test7ProducerConsumer(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction5.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    //while(countData > 1)
+    for(int i = 0; i < 2; i++)
+    {
+        err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+        err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+        err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
+        err = kernel.setArg(4, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(5, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+
+        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        cl::NDRange local(LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
+
+        countData = WORK_GROUP_COUNT;
+        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
+
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
+    }
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
+
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+uint64_t test8Coalesced(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+    
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction6.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    //while(countData > 1)
+    for(int i = 0; i < 2; i++)
+    {
+        err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+        err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+        err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
+        err = kernel.setArg(4, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(5, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+
+        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        cl::NDRange local(LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
+
+        countData = WORK_GROUP_COUNT;
+        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
+
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
+    }
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
+
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+
+
+
+uint64_t test9Subgroups(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction7.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, (kernelBuildOptions + " " + buildOptions).c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    for(int i = 0; i < 2; i++)
+    {
+        err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+        err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+        err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
+
+        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        cl::NDRange local(LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
+
+        countData = WORK_GROUP_COUNT;
+        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
+
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
+    }
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
+
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+
+
+uint64_t test10VectorLoads(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction8.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, (kernelBuildOptions + " " + buildOptions).c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
     }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
 
-    // Join threads
-    for (size_t i = 0; i < num_threads; ++i) {
-        threads[i].join();
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
     }
+    for(int i = 0; i < 2; i++)
+    {
+        err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+        err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+        err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
 
-    // Calculate final sum
-    uint32_t final_sum = std::accumulate(results.begin(), results.end(), 0);
+        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        cl::NDRange local(LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
+
+        countData = WORK_GROUP_COUNT;
+        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
+
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
+    }
+    commandQueue.finish();
     auto aend_time = std::chrono::steady_clock::now();
-    if(correctResult != final_sum){exit(-69);}
+
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
     return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
-uint64_t test3Dournac(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+uint64_t test11TailSplit(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
 {
     auto astart_time = std::chrono::steady_clock::now();
-    
+
     cl_int err;
-    std::vector<uint32_t> hostGlobalOutput(size);
-    std::ifstream sourceFile("..//sumReduction1.cl");
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction9.cl"));
     std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
     cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
     cl::Program program = cl::Program(context, source);
 
-    program.build(devicesToUse);
+    program.build(devicesToUse, kernelBuildOptions.c_str());
     std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
     cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
 
@@ -496,53 +2369,57 @@ uint64_t test3Dournac(uint32_t correctResult, std::vector<uint32_t>* arr, size_t
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeData, arr->data(), &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
     cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
 
     if(!measureSetupTime)
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    while(countData > 1)
-    //for(int i = 0; i < 2; i++)
+    for(int i = 0; i < 2; i++)
     {
         err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
         err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
         err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
         err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
-        //err = kernel.setArg(4, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
-        //err = kernel.setArg(5, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
 
-        cl::NDRange global(countData);
-        cl::NDRange local(LOCAL_SIZE > countData ? countData : LOCAL_SIZE);
-        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local); CHECK_ERROR(err);
+        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        cl::NDRange local(LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
 
-        countData = countData / LOCAL_SIZE;
-        sizeData = countData * sizeof(DATA_TYPE);
+        countData = WORK_GROUP_COUNT;
+        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
 
-        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData);
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
     }
-    cl::finish();
+    commandQueue.finish();
     auto aend_time = std::chrono::steady_clock::now();
 
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
 
-    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(uint32_t) * size, hostGlobalOutput.data());
-
-    if(correctResult != hostGlobalOutput[0]){std::cout << "!" << hostGlobalOutput[0]<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
     return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
-uint64_t test4Catanzaro(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+uint64_t test12UnrolledTree(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions)
 {
     auto astart_time = std::chrono::steady_clock::now();
-    
+
     cl_int err;
-    std::vector<uint32_t> hostGlobalOutput(size);
-    std::ifstream sourceFile("..//sumReduction2.cl");
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction10.cl"));
     std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
     cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
     cl::Program program = cl::Program(context, source);
 
-    program.build(devicesToUse);
+    program.build(devicesToUse, (kernelBuildOptions + " " + buildOptions).c_str());
     std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
     cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
 
@@ -552,53 +2429,115 @@ uint64_t test4Catanzaro(uint32_t correctResult, std::vector<uint32_t>* arr, size
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeData, arr->data(), &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
     cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
 
     if(!measureSetupTime)
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    while(countData > 1)
-        //for(int i = 0; i < 2; i++)
+    for(int i = 0; i < 2; i++)
     {
         err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
         err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
         err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
         err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
-        //err = kernel.setArg(4, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
-        //err = kernel.setArg(5, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
 
-        cl::NDRange global(countData);
-        cl::NDRange local(LOCAL_SIZE > countData ? countData : LOCAL_SIZE);
-        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local); CHECK_ERROR(err);
+        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        cl::NDRange local(LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
 
-        countData = countData / LOCAL_SIZE;
-        sizeData = countData * sizeof(DATA_TYPE);
+        countData = WORK_GROUP_COUNT;
+        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
 
-        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData);
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
     }
-    cl::finish();
+    commandQueue.finish();
     auto aend_time = std::chrono::steady_clock::now();
 
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
+
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+uint64_t test13GlobalAtomic(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions)
+{
+    auto astart_time = std::chrono::steady_clock::now();
+
+    cl_int err;
+    bool wideAccumulator = buildOptions.find("USE_INT64_ATOMICS") != std::string::npos;
+    size_t accumulatorSize = wideAccumulator ? sizeof(cl_ulong) : sizeof(DATA_TYPE);
+    cl_ulong hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction11.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, (kernelBuildOptions + " " + buildOptions).c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
+
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    size_t countData = size;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(cl_ulong), nullptr, &err); CHECK_ERROR(err);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents(1);
+    std::vector<cl::Event> copyEvents(1);
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    //the accumulator has to start from zero on every run, this takes the place of the copy phase
+    err = commandQueue.enqueueFillBuffer(kernelGlobalOutput, cl_ulong(0), 0, sizeof(cl_ulong), nullptr, &copyEvents[0]); CHECK_ERROR(err);
+
+    err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+    err = kernel.setArg(1, cl::Local(LOCAL_SIZE * accumulatorSize)); CHECK_ERROR(err);
+    err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+    err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
+
+    //one group per LOCAL_SIZE block like test3Dournac, so the number of atomic adds on the
+    //single total grows with the sweep and the point where contention dominates shows up
+    cl::NDRange global((countData + LOCAL_SIZE - 1) / LOCAL_SIZE * LOCAL_SIZE);
+    cl::NDRange local(LOCAL_SIZE);
+    err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents[0]); CHECK_ERROR(err);
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
 
-    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(uint32_t) * size, hostGlobalOutput.data());
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, accumulatorSize, &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
 
-    if(correctResult != hostGlobalOutput[0]){std::cout << "!" << hostGlobalOutput[0]<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    //the 64 bit total is exact, its low word has to match the wrapping 32 bit reference
+    if(correctResult != static_cast<DATA_TYPE>(hostGlobalOutput)){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
     return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
-uint64_t test5Divergence(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+uint64_t test14MultiAccumulator(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, const std::string& buildOptions)
 {
     auto astart_time = std::chrono::steady_clock::now();
-    
+
     cl_int err;
-    std::vector<uint32_t> hostGlobalOutput(size);
-    std::ifstream sourceFile("..//sumReduction3.cl");
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction12.cl"));
     std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
     cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
     cl::Program program = cl::Program(context, source);
 
-    program.build(devicesToUse);
+    program.build(devicesToUse, (kernelBuildOptions + " " + buildOptions).c_str());
     std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
     cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
 
@@ -608,53 +2547,57 @@ uint64_t test5Divergence(uint32_t correctResult, std::vector<uint32_t>* arr, siz
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeData, arr->data(), &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
     cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
 
     if(!measureSetupTime)
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    while(countData > 1)
-        //for(int i = 0; i < 2; i++)
+    for(int i = 0; i < 2; i++)
     {
         err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
         err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
         err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
         err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
-        //err = kernel.setArg(4, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
-        //err = kernel.setArg(5, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
 
-        cl::NDRange global(countData);
-        cl::NDRange local(LOCAL_SIZE > countData ? countData : LOCAL_SIZE);
-        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local); CHECK_ERROR(err);
+        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        cl::NDRange local(LOCAL_SIZE);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
 
-        countData = countData / LOCAL_SIZE;
-        sizeData = countData * sizeof(DATA_TYPE);
+        countData = WORK_GROUP_COUNT;
+        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
 
-        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData);
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
     }
-    cl::finish();
+    commandQueue.finish();
     auto aend_time = std::chrono::steady_clock::now();
 
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
 
-    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(uint32_t) * size, hostGlobalOutput.data());
-
-    if(correctResult != hostGlobalOutput[0]){std::cout << "!" << hostGlobalOutput[0]<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
     return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
-uint64_t test6LoopUnrolling(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+uint64_t test15ProConInterleaved(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
 {
     auto astart_time = std::chrono::steady_clock::now();
-    
+
     cl_int err;
-    std::vector<uint32_t> hostGlobalOutput(size);
-    std::ifstream sourceFile("..//sumReduction4.cl");
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction13.cl"));
     std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
     cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
     cl::Program program = cl::Program(context, source);
 
-    program.build(devicesToUse);
+    program.build(devicesToUse, kernelBuildOptions.c_str());
     std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
     cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
 
@@ -664,53 +2607,59 @@ uint64_t test6LoopUnrolling(uint32_t correctResult, std::vector<uint32_t>* arr,
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeData, arr->data(), &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
     cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
 
     if(!measureSetupTime)
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    //while(countData > 1)
     for(int i = 0; i < 2; i++)
     {
         err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
         err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
         err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
         err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
-        //err = kernel.setArg(4, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
-        //err = kernel.setArg(5, cl::Local(WORK_GROUP_COUNT*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(4, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(5, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
 
         cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
         cl::NDRange local(LOCAL_SIZE);
-        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local); CHECK_ERROR(err);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
 
         countData = WORK_GROUP_COUNT;
         sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
 
-        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData);
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
     }
-    cl::finish();
+    commandQueue.finish();
     auto aend_time = std::chrono::steady_clock::now();
 
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
 
-    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(uint32_t) * size, hostGlobalOutput.data());
-
-    if(correctResult != hostGlobalOutput[0]){std::cout << "!" << hostGlobalOutput[0]<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
     return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
-uint64_t test7ProducerConsumer(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+uint64_t test16AsyncPrefetch(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
 {
     auto astart_time = std::chrono::steady_clock::now();
-    
+
     cl_int err;
-    std::vector<uint32_t> hostGlobalOutput(size);
-    std::ifstream sourceFile("..//sumReduction5.cl");
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction14.cl"));
     std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
     cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
     cl::Program program = cl::Program(context, source);
 
-    program.build(devicesToUse);
+    program.build(devicesToUse, kernelBuildOptions.c_str());
     std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
     cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
 
@@ -720,53 +2669,59 @@ uint64_t test7ProducerConsumer(uint32_t correctResult, std::vector<uint32_t>* ar
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeData, arr->data(), &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
     cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
 
     if(!measureSetupTime)
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    //while(countData > 1)
     for(int i = 0; i < 2; i++)
     {
         err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
         err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
         err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
         err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
-        err = kernel.setArg(4, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
-        err = kernel.setArg(5, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(4, cl::Local(8*LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(5, cl::Local(8*LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
 
         cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
         cl::NDRange local(LOCAL_SIZE);
-        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local); CHECK_ERROR(err);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
 
         countData = WORK_GROUP_COUNT;
         sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
 
-        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData);
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
     }
-    cl::finish();
+    commandQueue.finish();
     auto aend_time = std::chrono::steady_clock::now();
 
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
 
-    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(uint32_t) * size, hostGlobalOutput.data());
-
-    if(correctResult != hostGlobalOutput[0]){std::cout << "!" << hostGlobalOutput[0]<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
     return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
-uint64_t test8Coalesced(uint32_t correctResult, std::vector<uint32_t>* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
+uint64_t test17PersistentThreads(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, size_t persistentGroups)
 {
     auto astart_time = std::chrono::steady_clock::now();
-    
+
     cl_int err;
-    std::vector<uint32_t> hostGlobalOutput(size);
-    std::ifstream sourceFile("..//sumReduction6.cl");
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction15.cl"));
     std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
     cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
     cl::Program program = cl::Program(context, source);
 
-    program.build(devicesToUse);
+    program.build(devicesToUse, kernelBuildOptions.c_str());
     std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
     cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
 
@@ -776,66 +2731,342 @@ uint64_t test8Coalesced(uint32_t correctResult, std::vector<uint32_t>* arr, size
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeData, arr->data(), &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_ONLY, sizeData, nullptr, &err); CHECK_ERROR(err);
     cl::Buffer kernelGlobalOutput = cl::Buffer(context, CL_MEM_KERNEL_READ_AND_WRITE, sizeData);
+    cl::Buffer chunkCounter = cl::Buffer(context, CL_MEM_READ_WRITE, sizeof(cl_uint), nullptr, &err); CHECK_ERROR(err);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents;
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
 
     if(!measureSetupTime)
     {
         astart_time = std::chrono::steady_clock::now();
     }
-    //while(countData > 1)
     for(int i = 0; i < 2; i++)
     {
         err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
         err = kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
         err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
         err = kernel.setArg(3, kernelGlobalOutput); CHECK_ERROR(err);
-        err = kernel.setArg(4, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
-        err = kernel.setArg(5, cl::Local(8*LOCAL_SIZE/2 * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+        err = kernel.setArg(4, chunkCounter); CHECK_ERROR(err);
+        err = commandQueue.enqueueFillBuffer(chunkCounter, cl_uint(0), 0, sizeof(cl_uint)); CHECK_ERROR(err);
 
-        cl::NDRange global(LOCAL_SIZE*WORK_GROUP_COUNT);
+        //just enough groups to stay resident, the second pass folds their partials in a single group
+        size_t groups = (i == 0) ? persistentGroups : 1;
+        cl::NDRange global(LOCAL_SIZE*groups);
         cl::NDRange local(LOCAL_SIZE);
-        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local); CHECK_ERROR(err);
+        kernelEvents.emplace_back();
+        err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &kernelEvents.back()); CHECK_ERROR(err);
 
-        countData = WORK_GROUP_COUNT;
-        sizeData = WORK_GROUP_COUNT * sizeof(DATA_TYPE);
+        countData = groups;
+        sizeData = groups * sizeof(DATA_TYPE);
 
-        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData);
+        copyEvents.emplace_back();
+        commandQueue.enqueueCopyBuffer(kernelGlobalOutput, kernelGlobalInput, 0, 0, sizeData, nullptr, &copyEvents.back());
     }
-    cl::finish();
+    commandQueue.finish();
     auto aend_time = std::chrono::steady_clock::now();
 
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
 
-    commandQueue.enqueueReadBuffer(kernelGlobalOutput, CL_TRUE, 0, sizeof(uint32_t) * size, hostGlobalOutput.data());
-
-    if(correctResult != hostGlobalOutput[0]){std::cout << "!" << hostGlobalOutput[0]<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
     return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
+uint64_t test18DeviceEnqueue(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse, bool deviceEnqueue)
+{
+    if(!deviceEnqueue)
+    {
+        //OpenCL 1.2 devices keep the host driven loop
+        return test3Dournac(correctResult, arr, size, context, commandQueue, devicesToUse);
+    }
+    auto astart_time = std::chrono::steady_clock::now();
+
+    cl_int err;
+    DATA_TYPE hostGlobalOutput = 0;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction16.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
+
+    program.build(devicesToUse, (kernelBuildOptions + " -cl-std=CL2.0").c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    cl::Kernel kernel (program, "reduce", &err); CHECK_ERROR(err);
 
+    size_t sizeData = size * sizeof(DATA_TYPE);
+    cl_int countData = size;
+    cl_uint localSize = LOCAL_SIZE;
+    if(measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    cl::Buffer kernelGlobalInput = cl::Buffer(context, CL_MEM_READ_WRITE, sizeData, nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelGlobalScratch = cl::Buffer(context, CL_MEM_READ_WRITE, std::max<size_t>(1, size / LOCAL_SIZE) * sizeof(DATA_TYPE), nullptr, &err); CHECK_ERROR(err);
+    cl::Buffer kernelStatus = cl::Buffer(context, CL_MEM_WRITE_ONLY, sizeof(cl_int), nullptr, &err); CHECK_ERROR(err);
+    cl::Event uploadEvent;
+    std::vector<cl::Event> kernelEvents(1);
+    std::vector<cl::Event> copyEvents;
+    err = uploadInput(commandQueue, kernelGlobalInput, arr, sizeData, &uploadEvent); CHECK_ERROR(err);
 
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    //one launch from the host, the kernel enqueues all passes itself and only completes with its children
+    err = kernel.setArg(0, kernelGlobalInput); CHECK_ERROR(err);
+    err = kernel.setArg(1, kernelGlobalScratch); CHECK_ERROR(err);
+    err = kernel.setArg(2, sizeof(cl_int), &countData); CHECK_ERROR(err);
+    err = kernel.setArg(3, sizeof(cl_uint), &localSize); CHECK_ERROR(err);
+    err = kernel.setArg(4, kernelStatus); CHECK_ERROR(err);
+    err = commandQueue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, &kernelEvents[0]); CHECK_ERROR(err);
+    commandQueue.finish();
+    auto aend_time = std::chrono::steady_clock::now();
 
+    //a failed device-side enqueue leaves a partial sum behind, report that instead of a mismatch
+    cl_int deviceStatus = CL_SUCCESS;
+    err = commandQueue.enqueueReadBuffer(kernelStatus, CL_TRUE, 0, sizeof(cl_int), &deviceStatus); CHECK_ERROR(err);
+    if(deviceStatus != CL_SUCCESS){std::cerr << "enqueue_kernel failed on the device: " << deviceStatus << std::endl; exit(EXIT_FAILURE);}
 
+    //the passes alternate between the buffers, the same count as the host loop of test3Dournac
+    int passes = 0;
+    for(size_t count = size; count > 1; count = count / LOCAL_SIZE)
+    {
+        passes++;
+    }
+    cl::Event readbackEvent;
+    commandQueue.enqueueReadBuffer(passes % 2 ? kernelGlobalScratch : kernelGlobalInput, CL_TRUE, 0, sizeof(DATA_TYPE), &hostGlobalOutput, nullptr, &readbackEvent);
+    recordPhases(uploadEvent, kernelEvents, copyEvents, readbackEvent);
 
-uint32_t sumReductionCpu(std::vector<uint32_t>* array, uint64_t size)
+    if(correctResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << correctResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
+}
+uint64_t test23Incremental(uint32_t correctResult, HostArray* arr, size_t size, cl::Context context, cl::CommandQueue commandQueue, std::vector<cl::Device>& devicesToUse)
 {
-    uint32_t sum = 0U;
-    for(uint64_t i = 0; i < size; i++)
+    auto astart_time = std::chrono::steady_clock::now();
+    //full pass that keeps every level of partials
+    IncrementalReduction state = createIncrementalReduction(context, commandQueue, devicesToUse, arr, size);
+    commandQueue.finish();
+    state.kernelEvents.clear();
+
+    //every element of the updated ranges grows by one. Each region is split in two ranges a few
+    //elements apart, which share blocks and have to be merged, the regions themselves merge further up.
+    size_t regionCount = std::max<size_t>(2, static_cast<size_t>(size * INCREMENTAL_UPDATE_FRACTION / INCREMENTAL_UPDATE_REGIONS));
+    size_t gap = LOCAL_SIZE / 4;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for(size_t r = 0; r < INCREMENTAL_UPDATE_REGIONS; r++)
+    {
+        size_t offset = r * (size / INCREMENTAL_UPDATE_REGIONS) + (size / INCREMENTAL_UPDATE_REGIONS - regionCount - gap) / 2;
+        ranges.emplace_back(offset, offset + regionCount / 2);
+        ranges.emplace_back(offset + regionCount / 2 + gap, offset + regionCount + gap);
+    }
+    std::vector<std::vector<uint32_t>> updates;
+    uint32_t expectedResult = correctResult;
+    for(const std::pair<size_t, size_t>& range : ranges)
+    {
+        updates.emplace_back(arr->data() + range.first, arr->data() + range.second);
+        for(uint32_t& value : updates.back())
+        {
+            value += 1;
+        }
+        expectedResult += static_cast<uint32_t>(range.second - range.first);
+    }
+
+    if(!measureSetupTime)
+    {
+        astart_time = std::chrono::steady_clock::now();
+    }
+    std::vector<cl::Event> uploadEvents(ranges.size());
+    for(size_t r = 0; r < ranges.size(); r++)
     {
-        sum += (*array)[i];
+        updateIncremental(state, commandQueue, ranges[r].first, updates[r].data(), updates[r].size(), &uploadEvents[r]);
     }
-    return sum;
+    cl::Event readbackEvent;
+    DATA_TYPE hostGlobalOutput = incrementalTotal(state, commandQueue, &readbackEvent);
+    auto aend_time = std::chrono::steady_clock::now();
+    recordPhases(uploadEvents[0], state.kernelEvents, std::vector<cl::Event>(), readbackEvent);
+    for(size_t r = 1; r < uploadEvents.size(); r++)
+    {
+        lastPhases.upload += eventDuration(uploadEvents[r]);
+    }
+
+    if(expectedResult != hostGlobalOutput){std::cout << "!" << hostGlobalOutput<< "!" << expectedResult << "!" << "\n";std::exit(-69);}
+    return std::chrono::duration_cast<std::chrono::microseconds>(aend_time - astart_time).count();
 }
-std::vector<uint32_t>* createdArray(uint32_t size)
+IncrementalReduction createIncrementalReduction(cl::Context context, cl::CommandQueue& commandQueue, std::vector<cl::Device>& devicesToUse, HostArray* arr, size_t size)
 {
-    auto array = new std::vector<uint32_t>(size);
-    std::srand(time(nullptr));
-    for(uint32_t i = 0; i < size; i++)
-    {
-        (*array)[i] = static_cast<uint32_t>(N_ELEMENTS  + 419 - i + (static_cast<DATA_TYPE>(rand()) / RAND_MAX) * 133769);
+    cl_int err;
+    IncrementalReduction state;
+    std::ifstream sourceFile(KERNEL_PATH("sumReduction17.cl"));
+    std::string sourceCode(std::istreambuf_iterator<char>(sourceFile), (std::istreambuf_iterator<char>()));
+    cl::Program::Sources source(1, std::make_pair(sourceCode.c_str(), sourceCode.length()));
+    cl::Program program = cl::Program(context, source);
 
-        //(*array)[i] = N_ELEMENTS - i + 13;
-        //(*array)[i] = N_ELEMENTS - i;
-        //*array)[i] = 1;
+    program.build(devicesToUse, kernelBuildOptions.c_str());
+    std::cout << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devicesToUse[0]);
+    state.kernel = cl::Kernel(program, "reduce", &err); CHECK_ERROR(err);
+
+    state.size = size;
+    state.data = cl::Buffer(context, CL_MEM_READ_WRITE, size * sizeof(DATA_TYPE), nullptr, &err); CHECK_ERROR(err);
+    cl::Event uploadEvent;
+    err = uploadInput(commandQueue, state.data, arr, size * sizeof(DATA_TYPE), &uploadEvent); CHECK_ERROR(err);
+    //level l holds one partial per LOCAL_SIZE block of level l - 1, the last level is the total
+    for(size_t count = size; count > 1 || state.levels.empty(); )
+    {
+        count = (count + LOCAL_SIZE - 1) / LOCAL_SIZE;
+        state.levelCounts.push_back(count);
+        state.levels.push_back(cl::Buffer(context, CL_MEM_READ_WRITE, count * sizeof(DATA_TYPE), nullptr, &err)); CHECK_ERROR(err);
+    }
+    for(size_t level = 0; level < state.levels.size(); level++)
+    {
+        reduceIncrementalBlocks(state, commandQueue, level, 0, state.levelCounts[level]);
+    }
+    return state;
+}
+void updateIncremental(IncrementalReduction& state, cl::CommandQueue& commandQueue, size_t offset, const uint32_t* values, size_t count, cl::Event* uploadEvent)
+{
+    //values is read asynchronously and has to stay valid until the next incrementalTotal
+    if(count == 0)
+    {
+        return;
+    }
+    cl_int err = commandQueue.enqueueWriteBuffer(state.data, CL_FALSE, offset * sizeof(DATA_TYPE), count * sizeof(DATA_TYPE), values, nullptr, uploadEvent); CHECK_ERROR(err);
+    state.dirty.emplace_back(offset, offset + count);
+}
+uint32_t incrementalTotal(IncrementalReduction& state, cl::CommandQueue& commandQueue, cl::Event* readbackEvent)
+{
+    //dirty element ranges become dirty block ranges, which are the dirty element ranges of the next level
+    std::vector<std::pair<size_t, size_t>> ranges = state.dirty;
+    for(size_t level = 0; level < state.levels.size() && !ranges.empty(); level++)
+    {
+        for(std::pair<size_t, size_t>& range : ranges)
+        {
+            range.first = range.first / LOCAL_SIZE;
+            range.second = (range.second + LOCAL_SIZE - 1) / LOCAL_SIZE;
+        }
+        //overlapping or touching block ranges are reduced by one launch
+        std::sort(ranges.begin(), ranges.end());
+        std::vector<std::pair<size_t, size_t>> merged;
+        for(const std::pair<size_t, size_t>& range : ranges)
+        {
+            if(!merged.empty() && range.first <= merged.back().second)
+            {
+                merged.back().second = std::max(merged.back().second, range.second);
+            }
+            else
+            {
+                merged.push_back(range);
+            }
+        }
+        for(const std::pair<size_t, size_t>& range : merged)
+        {
+            reduceIncrementalBlocks(state, commandQueue, level, range.first, range.second - range.first);
+        }
+        ranges = merged;
+    }
+    state.dirty.clear();
+    DATA_TYPE total = 0;
+    cl_int err = commandQueue.enqueueReadBuffer(state.levels.back(), CL_TRUE, 0, sizeof(DATA_TYPE), &total, nullptr, readbackEvent); CHECK_ERROR(err);
+    return total;
+}
+void reduceIncrementalBlocks(IncrementalReduction& state, cl::CommandQueue& commandQueue, size_t level, size_t firstBlock, size_t blockCount)
+{
+    cl_int err;
+    cl::Buffer& input = level == 0 ? state.data : state.levels[level - 1];
+    cl_int length = level == 0 ? state.size : state.levelCounts[level - 1];
+    cl_int firstGroup = firstBlock;
+    err = state.kernel.setArg(0, input); CHECK_ERROR(err);
+    err = state.kernel.setArg(1, cl::Local(LOCAL_SIZE * sizeof(DATA_TYPE))); CHECK_ERROR(err);
+    err = state.kernel.setArg(2, sizeof(cl_int), &length); CHECK_ERROR(err);
+    err = state.kernel.setArg(3, sizeof(cl_int), &firstGroup); CHECK_ERROR(err);
+    err = state.kernel.setArg(4, state.levels[level]); CHECK_ERROR(err);
+    state.kernelEvents.emplace_back();
+    err = commandQueue.enqueueNDRangeKernel(state.kernel, cl::NullRange, cl::NDRange(blockCount * LOCAL_SIZE), cl::NDRange(LOCAL_SIZE), nullptr, &state.kernelEvents.back()); CHECK_ERROR(err);
+}
+bool deviceHasExtension(const cl::Device& device, const std::string& extension)
+{
+    std::istringstream extensions(device.getInfo<CL_DEVICE_EXTENSIONS>().c_str());
+    std::string current;
+    while(extensions >> current)
+    {
+        if(current == extension)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+std::string subgroupBuildOptions(const cl::Device& device)
+{
+    //empty when the device has no sub group support at all
+    if(deviceHasExtension(device, "cl_khr_subgroups"))
+    {
+        return "-cl-std=CL2.0 -DUSE_KHR_SUBGROUPS";
+    }
+    if(deviceHasExtension(device, "cl_intel_subgroups"))
+    {
+        return "-DUSE_INTEL_SUBGROUPS";
+    }
+    return "";
+}
+std::string vectorWidthBuildOptions(const cl::Device& device)
+{
+    //CPU runtimes report their SIMD width here, GPUs mostly 1 or 4 but still profit from 16 byte loads
+    cl_uint preferred = device.getInfo<CL_DEVICE_PREFERRED_VECTOR_WIDTH_INT>();
+    return preferred >= 8 ? "-DVECTOR_WIDTH=8" : "-DVECTOR_WIDTH=4";
+}
+std::string unrolledTreeBuildOptions(const cl::Device& device)
+{
+    std::string options = "-DGROUP_SIZE=" + std::to_string(LOCAL_SIZE);
+    //only AMD documents lockstep wavefronts, everywhere else each tree step keeps its barrier
+    if(deviceHasExtension(device, "cl_amd_device_attribute_query"))
+    {
+        cl_uint wavefrontWidth = 0;
+        if(clGetDeviceInfo(device(), CL_DEVICE_WAVEFRONT_WIDTH_AMD, sizeof(cl_uint), &wavefrontWidth, nullptr) == CL_SUCCESS && wavefrontWidth > 1)
+        {
+            options += " -DWAVEFRONT_SIZE=" + std::to_string(wavefrontWidth);
+        }
     }
+    return options;
+}
+std::string globalAtomicBuildOptions(const cl::Device& device)
+{
+    //32 bit global atomics are core since OpenCL 1.1, the 64 bit ones give an exact total
+    return deviceHasExtension(device, "cl_khr_int64_base_atomics") ? "-DUSE_INT64_ATOMICS" : "";
+}
+cl_command_queue createDeviceQueue(cl::Context context, cl::Device device)
+{
+#ifdef CL_VERSION_2_0
+    //OpenCL 3.0 made device side enqueue optional, an empty capability means unsupported
+    std::string version(device.getInfo<CL_DEVICE_VERSION>().c_str());
+    if(version.compare(0, 9, "OpenCL 2.") != 0 && version.compare(0, 9, "OpenCL 3.") != 0)
+    {
+        return nullptr;
+    }
+    if(version.compare(0, 9, "OpenCL 3.") == 0)
+    {
+        cl_bitfield capabilities = 0;
+        if(clGetDeviceInfo(device(), CL_DEVICE_DEVICE_ENQUEUE_CAPABILITIES, sizeof(capabilities), &capabilities, nullptr) != CL_SUCCESS || capabilities == 0)
+        {
+            return nullptr;
+        }
+    }
+    cl_queue_properties properties[] = {CL_QUEUE_PROPERTIES, CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE | CL_QUEUE_ON_DEVICE | CL_QUEUE_ON_DEVICE_DEFAULT, 0};
+    cl_int err;
+    cl_command_queue queue = clCreateCommandQueueWithProperties(context(), device(), properties, &err);
+    return err == CL_SUCCESS ? queue : nullptr;
+#else
+    return nullptr;
+#endif
+}
+uint32_t sumReductionCpu(const uint32_t* array, uint64_t size)
+{
+    return reduceCpuAuto(array, size);
+}
+HostArray* createdArray(uint32_t size)
+{
+    auto array = new HostArray(size);
+    fillInput(array->data(), size, inputSeed);
     return array;
-}
\ No newline at end of file
+}
@@ -0,0 +1,73 @@
+#ifndef PARALLELREDUCTION_RANGEINDEX_HPP
+#define PARALLELREDUCTION_RANGEINDEX_HPP
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "cpuReduction.hpp"
+
+// Every level of a reduction tree over an immutable array, one summary per block of
+// fanout elements of the level below, like the partials of one sumReduction1.cl pass each.
+// A query over [l, r) reduces the ragged ends of the range on each level and continues
+// with the whole blocks one level up, so it touches fewer than 2 * fanout values per level.
+template<typename T, typename Operator = SumOperator>
+class RangeIndex
+{
+public:
+    // The array is not copied and has to outlive the index
+    RangeIndex(const T* data, size_t size, size_t fanout) : data(data), size(size), fanout(fanout < 2 ? 2 : fanout)
+    {
+        const T* below = data;
+        size_t count = size;
+        while(count > 1)
+        {
+            size_t blocks = (count + this->fanout - 1) / this->fanout;
+            std::vector<T> level(blocks);
+            for(size_t b = 0; b < blocks; b++)
+            {
+                size_t begin = b * this->fanout;
+                size_t end = begin + this->fanout < count ? begin + this->fanout : count;
+                level[b] = reduceCpu<T, Operator>(below + begin, end - begin);
+            }
+            levels.push_back(std::move(level));
+            below = levels.back().data();
+            count = blocks;
+        }
+    }
+
+    // Aggregate of the elements [l, r), the identity for an empty range
+    T query(size_t l, size_t r) const
+    {
+        T result = Operator::template identity<T>();
+        if(r > size)
+        {
+            r = size;
+        }
+        const T* current = data;
+        for(size_t level = 0; l < r; level++)
+        {
+            size_t firstBlock = (l + fanout - 1) / fanout;
+            size_t endBlock = r / fanout;
+            if(firstBlock >= endBlock || level == levels.size())
+            {
+                //no whole block left in the range
+                return Operator::template apply<T>(result, reduceCpu<T, Operator>(current + l, r - l));
+            }
+            result = Operator::template apply<T>(result, reduceCpu<T, Operator>(current + l, firstBlock * fanout - l));
+            result = Operator::template apply<T>(result, reduceCpu<T, Operator>(current + endBlock * fanout, r - endBlock * fanout));
+            current = levels[level].data();
+            l = firstBlock;
+            r = endBlock;
+        }
+        return result;
+    }
+    size_t levelCount() const { return levels.size(); }
+
+private:
+    const T* data;
+    size_t size;
+    size_t fanout;
+    std::vector<std::vector<T>> levels;
+};
+
+#endif //PARALLELREDUCTION_RANGEINDEX_HPP
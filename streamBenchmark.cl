@@ -0,0 +1,22 @@
+__kernel void streamRead(global uint4* input,
+                         const int length,
+                         global uint* result)
+{
+    uint4 accumulator = (uint4)(0U);
+    // Grid stride over the whole buffer, every element is read exactly once
+    for (int i = get_global_id(0); i < length; i += get_global_size(0))
+    {
+        accumulator += input[i];
+    }
+    // Keep the loads alive
+    result[get_global_id(0)] = accumulator.x + accumulator.y + accumulator.z + accumulator.w;
+}
+__kernel void streamCopy(global uint4* input,
+                         const int length,
+                         global uint4* output)
+{
+    for (int i = get_global_id(0); i < length; i += get_global_size(0))
+    {
+        output[i] = input[i];
+    }
+}
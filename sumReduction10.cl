@@ -0,0 +1,56 @@
+#ifndef GROUP_SIZE
+#define GROUP_SIZE 128
+#endif
+// Work items of one wavefront execute in lockstep, steps inside a wavefront need no barrier.
+// 1 means no such guarantee and every step is fenced.
+#ifndef WAVEFRONT_SIZE
+#define WAVEFRONT_SIZE 1
+#endif
+
+// Compile time constants, the branches fold away and the tree is fully unrolled
+#define TREE_STEP(offset) \
+    if (GROUP_SIZE > (offset)) \
+    { \
+        if ((offset) >= WAVEFRONT_SIZE) \
+        { \
+            barrier(CLK_LOCAL_MEM_FENCE); \
+        } \
+        if (local_index < (offset)) \
+        { \
+            sum[local_index] += sum[local_index + (offset)]; \
+        } \
+    }
+
+__kernel __attribute__((reqd_work_group_size(GROUP_SIZE, 1, 1)))
+void reduce(global uint* input,
+            local uint* localSum,
+            const int length,
+            global uint* result)
+{
+    int global_index = get_global_id(0);
+    int local_index = get_local_id(0);
+    // volatile keeps the barrier free steps from caching their neighbours' values in registers
+    volatile local uint* sum = localSum;
+    uint accumulator = 0U;
+    // Loop sequentially over chunks of input vector
+    while (global_index < length)
+    {
+        accumulator += input[global_index];
+        global_index += get_global_size(0);
+    }
+    sum[local_index] = accumulator;
+    TREE_STEP(512)
+    TREE_STEP(256)
+    TREE_STEP(128)
+    TREE_STEP(64)
+    TREE_STEP(32)
+    TREE_STEP(16)
+    TREE_STEP(8)
+    TREE_STEP(4)
+    TREE_STEP(2)
+    TREE_STEP(1)
+    if (local_index == 0)
+    {
+        result [get_group_id(0)] = sum [0];
+    }
+}
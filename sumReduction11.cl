@@ -0,0 +1,39 @@
+#if defined(USE_INT64_ATOMICS)
+#pragma OPENCL EXTENSION cl_khr_int64_base_atomics : enable
+#define ACCUMULATOR_TYPE ulong
+#define GLOBAL_ADD(p, v) atom_add(p, v)
+#else
+#define ACCUMULATOR_TYPE uint
+#define GLOBAL_ADD(p, v) atomic_add(p, v)
+#endif
+
+__kernel void reduce(   global uint* input,
+                        local ACCUMULATOR_TYPE* localSum,
+                        const int length,
+                        global ACCUMULATOR_TYPE* result)
+{
+    int global_index = get_global_id(0);
+    ACCUMULATOR_TYPE accumulator = 0U;
+    // Loop sequentially over chunks of input vector
+    while (global_index < length)
+    {
+        accumulator += input[global_index];
+        global_index += get_global_size(0);
+    }
+    int local_index = get_local_id(0);
+    localSum[local_index] = accumulator;
+    int group_size = get_local_size(0);
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    // Fold the group result straight into the single total, no second pass
+    if (local_index == 0)
+    {
+        GLOBAL_ADD(result, localSum [0]);
+    }
+}
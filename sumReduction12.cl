@@ -0,0 +1,56 @@
+#ifndef ACCUMULATORS
+#define ACCUMULATORS 4
+#endif
+__kernel void reduce(global uint* input,
+                     local uint* localSum,
+                     const int length,
+                     global uint* result)
+{
+    int global_index = get_global_id(0);
+    int global_size = get_global_size(0);
+    int local_index = get_local_id(0);
+    int group_size = get_local_size(0);
+    int stride = global_size * ACCUMULATORS;
+    int bulk_length = (length / stride) * stride;
+
+    // Independent dependency chains, the loads of one round do not wait on each other's adds
+    uint accumulators[ACCUMULATORS];
+    #pragma unroll
+    for (int k = 0; k < ACCUMULATORS; k++)
+    {
+        accumulators[k] = 0U;
+    }
+    for (int pos = global_index; pos < bulk_length; pos += stride)
+    {
+        #pragma unroll
+        for (int k = 0; k < ACCUMULATORS; k++)
+        {
+            accumulators[k] += input[pos + k * global_size];
+        }
+    }
+    uint accumulator = 0U;
+    for (int pos = bulk_length + global_index; pos < length; pos += global_size)
+    {
+        accumulator += input[pos];
+    }
+    // Combine the chains only once the loop is done
+    #pragma unroll
+    for (int k = 0; k < ACCUMULATORS; k++)
+    {
+        accumulator += accumulators[k];
+    }
+    //Perform parallel reduction
+    localSum[local_index] = accumulator;
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    if (local_index == 0)
+    {
+        result [get_group_id(0)] = localSum [0];
+    }
+}
@@ -0,0 +1,78 @@
+#define UNROLLING_FACTOR 8
+
+void load(local uint* buffer_load, int pairs, int pair_index, const int length, global uint* input, int pos, int total_pairs);
+void compose(local uint* buffer_compose, int pairs, int pair_index, uint* accumulator);
+
+__kernel void reduce(global uint* input,
+                     local uint* localSum,
+                     const int length,
+                     global uint* result,
+                     local uint* buffer_load,
+                     local uint* buffer_compose)
+{
+    int global_size = get_global_size(0);
+    int local_index = get_local_id(0);
+    int group_size = get_local_size(0);
+    int group_index = get_group_id(0);
+    int is_producer = (local_index % 2 == 0);
+
+    // A producer and its consumer share a pair, element k of pair p lives at k * pairs + p.
+    // Neighbouring pairs touch neighbouring banks on every access. sumReduction6.cl gave each pair
+    // a block of UNROLLING_FACTOR consecutive words, so pairs sat 8 words apart and with 32 banks
+    // every fourth pair hit the same bank.
+    int pairs = group_size / 2;
+    int pair_index = local_index / 2;
+    int total_pairs = global_size / 2;
+    int global_pair = group_index * pairs + pair_index;
+    int stride = total_pairs * UNROLLING_FACTOR;
+    // Same trip count in every work item, so all of them meet every barrier
+    int rounds = (length + stride - 1) / stride;
+    local uint* swap;
+    uint accumulator = 0U;
+
+    // Producers fill round r while consumers sum round r - 1
+    for (int round = 0; round <= rounds; round++)
+    {
+        if(is_producer && round < rounds)
+        {
+            load(buffer_load, pairs, pair_index, length, input, round * stride + global_pair, total_pairs);
+        }
+        if(!is_producer && round > 0)
+        {
+            compose(buffer_compose, pairs, pair_index, &accumulator);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+        swap = buffer_load; buffer_load = buffer_compose; buffer_compose = swap;
+    }
+    //Perform parallel reduction
+
+    localSum[local_index] = accumulator;
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    if (local_index == 0)
+    {
+        result [group_index] = localSum [0];
+    }
+}
+void load(local uint* buffer_load, int pairs, int pair_index, const int length, global uint* input, int pos, int total_pairs)
+{
+    // Global reads are coalesced across pairs as well
+    for (int k = 0; k < UNROLLING_FACTOR; k++)
+    {
+        int element = pos + k * total_pairs;
+        buffer_load[k * pairs + pair_index] = (element < length) ? input[element] : 0U;
+    }
+}
+void compose(local uint* buffer_compose, int pairs, int pair_index, uint* accumulator)
+{
+    for (int k = 0; k < UNROLLING_FACTOR; k++)
+    {
+        *accumulator += buffer_compose[k * pairs + pair_index];
+    }
+}
@@ -0,0 +1,60 @@
+#define UNROLLING_FACTOR 8
+
+__kernel void reduce(global uint* input,
+                     local uint* localSum,
+                     const int length,
+                     global uint* result,
+                     local uint* buffer_load,
+                     local uint* buffer_compose)
+{
+    int local_index = get_local_id(0);
+    int group_size = get_local_size(0);
+    int group_index = get_group_id(0);
+    int group_count = get_num_groups(0);
+    // Every group walks its own tiles, the loop bounds only have to agree inside the group
+    int tile_size = group_size * UNROLLING_FACTOR;
+    int tile_count = (length + tile_size - 1) / tile_size;
+    local uint* swap;
+    uint accumulator = 0U;
+
+    int tile = group_index;
+    event_t copy_event = 0;
+    if (tile < tile_count)
+    {
+        copy_event = async_work_group_copy(buffer_load, input + tile * tile_size, min(tile_size, length - tile * tile_size), 0);
+    }
+    for (; tile < tile_count; tile += group_count)
+    {
+        wait_group_events(1, &copy_event);
+        swap = buffer_load; buffer_load = buffer_compose; buffer_compose = swap;
+
+        // Fetch the next tile while every lane sums the current one
+        int next_tile = tile + group_count;
+        if (next_tile < tile_count)
+        {
+            copy_event = async_work_group_copy(buffer_load, input + next_tile * tile_size, min(tile_size, length - next_tile * tile_size), 0);
+        }
+        int tile_length = min(tile_size, length - tile * tile_size);
+        for (int i = local_index; i < tile_length; i += group_size)
+        {
+            accumulator += buffer_compose[i];
+        }
+        // The tile has to be consumed before the next iteration copies over it
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    //Perform parallel reduction
+
+    localSum[local_index] = accumulator;
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    if (local_index == 0)
+    {
+        result [group_index] = localSum [0];
+    }
+}
@@ -0,0 +1,51 @@
+#define CHUNK_ROUNDS 16
+
+__kernel void reduce(global uint* input,
+                     local uint* localSum,
+                     const int length,
+                     global uint* result,
+                     volatile global uint* next_chunk)
+{
+    local uint chunk;
+    int local_index = get_local_id(0);
+    int group_size = get_local_size(0);
+    int chunk_size = group_size * CHUNK_ROUNDS;
+    uint chunk_count = (length + chunk_size - 1) / chunk_size;
+    uint accumulator = 0U;
+
+    // Claim chunks until the counter runs past the end, fast groups simply take more of them
+    while (true)
+    {
+        if (local_index == 0)
+        {
+            chunk = atomic_inc(next_chunk);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+        uint current = chunk;
+        // Everyone has read the claim before lane 0 makes the next one
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (current >= chunk_count)
+        {
+            break;
+        }
+        int end = min((int)(current + 1) * chunk_size, length);
+        for (int pos = current * chunk_size + local_index; pos < end; pos += group_size)
+        {
+            accumulator += input[pos];
+        }
+    }
+    //Perform parallel reduction
+    localSum[local_index] = accumulator;
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    if (local_index == 0)
+    {
+        result [get_group_id(0)] = localSum [0];
+    }
+}
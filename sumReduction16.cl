@@ -0,0 +1,79 @@
+// OpenCL 2.0: the passes of the Dournac loop are enqueued from the device instead of the host
+void reduce_pass(global uint* input,
+                 local uint* localSum,
+                 global uint* result)
+{
+    int local_index = get_local_id(0);
+    localSum[local_index] = input[get_global_id(0)];
+
+    int group_size = get_local_size(0);
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    if (local_index == 0)
+    {
+        result [get_group_id(0)] = localSum [0];
+    }
+}
+
+// Launched as a single work item, schedules every pass on the default device queue.
+// Passes alternate between input and scratch, each one waits for the previous to finish.
+// status receives the first failed enqueue_kernel code, no later pass is enqueued after it.
+__kernel void reduce(global uint* input,
+                     global uint* scratch,
+                     const int length,
+                     const uint local_size,
+                     global int* status)
+{
+    queue_t queue = get_default_queue();
+    global uint* source = input;
+    global uint* target = scratch;
+    global uint* swap;
+    clk_event_t previous;
+    clk_event_t done;
+    uint count = length;
+    bool first = true;
+    *status = CLK_SUCCESS;
+
+    while (count > 1)
+    {
+        uint group_size = min(local_size, count);
+        ndrange_t range = ndrange_1D(count, group_size);
+        global uint* pass_input = source;
+        global uint* pass_result = target;
+        int err;
+        if (first)
+        {
+            err = enqueue_kernel(queue, CLK_ENQUEUE_FLAGS_NO_WAIT, range, 0, NULL, &done,
+                                 ^(local void* localSum){ reduce_pass(pass_input, (local uint*)localSum, pass_result); },
+                                 group_size * sizeof(uint));
+        }
+        else
+        {
+            err = enqueue_kernel(queue, CLK_ENQUEUE_FLAGS_NO_WAIT, range, 1, &previous, &done,
+                                 ^(local void* localSum){ reduce_pass(pass_input, (local uint*)localSum, pass_result); },
+                                 group_size * sizeof(uint));
+            release_event(previous);
+        }
+        if (err != CLK_SUCCESS)
+        {
+            // done was never created, so there is nothing left to release
+            *status = err;
+            return;
+        }
+        previous = done;
+        first = false;
+
+        count = count / local_size;
+        swap = source; source = target; target = swap;
+    }
+    if (!first)
+    {
+        release_event(previous);
+    }
+}
@@ -0,0 +1,28 @@
+// Reduces the blocks firstGroup .. firstGroup + get_num_groups(0) - 1 of input, one block per work group.
+// The partial of block g always lands in result[g], so a launch over a few dirty blocks
+// patches a level of partials that was computed earlier.
+__kernel void reduce(   global const uint* input,
+                        local uint* localSum,
+                        const int length,
+                        const int firstGroup,
+                        global uint* result)
+{
+    int local_index = get_local_id(0);
+    int group = firstGroup + get_group_id(0);
+    int index = group * get_local_size(0) + local_index;
+    localSum[local_index] = index < length ? input[index] : 0;
+
+    int group_size = get_local_size(0);
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    if (local_index == 0)
+    {
+        result[group] = localSum[0];
+    }
+}
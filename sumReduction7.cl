@@ -0,0 +1,54 @@
+#if defined(USE_KHR_SUBGROUPS)
+#pragma OPENCL EXTENSION cl_khr_subgroups : enable
+uint sub_group_sum(uint value)
+{
+    return sub_group_reduce_add(value);
+}
+#elif defined(USE_INTEL_SUBGROUPS)
+#pragma OPENCL EXTENSION cl_intel_subgroups : enable
+uint sub_group_sum(uint value)
+{
+    // Shuffle tree, lanes past the end of the sub group read the zero "next" value
+    for (uint offset = get_sub_group_size()/2; offset > 0; offset = offset/2)
+    {
+        value += intel_sub_group_shuffle_down(value, 0U, offset);
+    }
+    return sub_group_broadcast(value, 0);
+}
+#endif
+
+__kernel void reduce(   global uint* input,
+                        local uint* localSum,
+                        const int length,
+                        global uint* result)
+{
+    int global_index = get_global_id(0);
+    uint accumulator = 0U;
+    // Loop sequentially over chunks of input vector
+    while (global_index < length)
+    {
+        accumulator += input[global_index];
+        global_index += get_global_size(0);
+    }
+    // Reduce inside the sub group without local memory or barriers
+    uint partial = sub_group_sum(accumulator);
+    if (get_sub_group_local_id() == 0)
+    {
+        localSum[get_sub_group_id()] = partial;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+    // The first sub group combines the sub group results
+    if (get_sub_group_id() == 0)
+    {
+        partial = 0U;
+        for (uint i = get_sub_group_local_id(); i < get_num_sub_groups(); i += get_sub_group_size())
+        {
+            partial += localSum[i];
+        }
+        partial = sub_group_sum(partial);
+        if (get_sub_group_local_id() == 0)
+        {
+            result [get_group_id(0)] = partial;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef VECTOR_WIDTH
+#define VECTOR_WIDTH 4
+#endif
+#if VECTOR_WIDTH == 8
+#define VECTOR_TYPE uint8
+#define VECTOR_LOAD vload8
+#define VECTOR_FOLD(v) ((v).s0 + (v).s1 + (v).s2 + (v).s3 + (v).s4 + (v).s5 + (v).s6 + (v).s7)
+#else
+#define VECTOR_TYPE uint4
+#define VECTOR_LOAD vload4
+#define VECTOR_FOLD(v) ((v).s0 + (v).s1 + (v).s2 + (v).s3)
+#endif
+
+__kernel void reduce(global uint* input,
+                     local uint* localSum,
+                     const int length,
+                     global uint* result)
+{
+    int global_index = get_global_id(0);
+    int global_size = get_global_size(0);
+    int local_index = get_local_id(0);
+    int group_size = get_local_size(0);
+    int vector_count = length / VECTOR_WIDTH;
+
+    // Loop sequentially over whole vectors, every load starts on a vector boundary
+    VECTOR_TYPE vector_accumulator = (VECTOR_TYPE)(0U);
+    for (int vector_index = global_index; vector_index < vector_count; vector_index += global_size)
+    {
+        vector_accumulator += VECTOR_LOAD(vector_index, input);
+    }
+    uint accumulator = VECTOR_FOLD(vector_accumulator);
+    // Elements after the last whole vector
+    for (int pos = vector_count * VECTOR_WIDTH + global_index; pos < length; pos += global_size)
+    {
+        accumulator += input[pos];
+    }
+    //Perform parallel reduction
+    localSum[local_index] = accumulator;
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    if (local_index == 0)
+    {
+        result [get_group_id(0)] = localSum [0];
+    }
+}
@@ -0,0 +1,48 @@
+#define UNROLLING_FACTOR 8
+__kernel void reduce(global uint* input,
+                     local uint* localSum,
+                     const int length,
+                     global uint* result)
+{
+    int global_index = get_global_id(0);
+    int global_size = get_global_size(0);
+    int local_index = get_local_id(0);
+    int group_size = get_local_size(0);
+    int stride = global_size * UNROLLING_FACTOR;
+    // Every work item reads a full chunk in each round up to here
+    int bulk_length = (length / stride) * stride;
+
+    uint accumulator = 0U;
+    // Unmasked main loop over the aligned bulk
+    for (int pos = global_index * UNROLLING_FACTOR; pos < bulk_length; pos += stride)
+    {
+        accumulator +=
+            (input[pos + 0]
+            +input[pos + 1]
+            +input[pos + 2]
+            +input[pos + 3]
+            +input[pos + 4]
+            +input[pos + 5]
+            +input[pos + 6]
+            +input[pos + 7]);
+    }
+    // Less than one round remains, spread it element by element so no load leaves the buffer
+    for (int pos = bulk_length + global_index; pos < length; pos += global_size)
+    {
+        accumulator += input[pos];
+    }
+    //Perform parallel reduction
+    localSum[local_index] = accumulator;
+    for (int offset = group_size/2; offset > 0; offset = offset/2)
+    {
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (local_index < offset)
+        {
+            localSum[local_index] += localSum[local_index + offset];
+        }
+    }
+    if (local_index == 0)
+    {
+        result [get_group_id(0)] = localSum [0];
+    }
+}
@@ -0,0 +1,191 @@
+#ifndef PARALLELREDUCTION_WINDOWREDUCTION_HPP
+#define PARALLELREDUCTION_WINDOWREDUCTION_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include "cpuReduction.hpp"
+
+// Reduces one contiguous block of a stream. Defaults to reduceCpu; blocks of at least
+// minimumSize elements go to the optional external reducer, e.g. one of the device kernels.
+template<typename T, typename Operator>
+struct BlockReducer
+{
+    std::function<T(const T*, size_t)> external;
+    size_t minimumSize = 0;
+    mutable size_t externalCalls = 0; //blocks that actually went to the external reducer
+
+    bool usesExternal(size_t size) const { return external && size >= minimumSize; }
+    T operator()(const T* data, size_t size) const
+    {
+        if(usesExternal(size))
+        {
+            externalCalls++;
+            return external(data, size);
+        }
+        return reduceCpu<T, Operator>(data, size);
+    }
+};
+
+// Aggregate over the last window elements of a stream in amortized O(1) per element,
+// also for operators without an inverse like min and max.
+// Two-stacks queue: appended elements only fold into one running aggregate of the back,
+// the front keeps suffix aggregates of older elements so evicting is moving an index.
+// When the front runs dry the back is turned into suffix aggregates once.
+template<typename T, typename Operator = SumOperator>
+class SlidingWindow
+{
+public:
+    explicit SlidingWindow(size_t window) : window(std::max<size_t>(1, window)) {}
+
+    void setBlockReducer(const BlockReducer<T, Operator>& blockReducer) { reducer = blockReducer; }
+
+    // Appends count elements, the block is folded into the back aggregate in one reduction
+    void push(const T* values, size_t count)
+    {
+        if(count >= window)
+        {
+            //everything older falls out of the window anyway
+            values += count - window;
+            count = window;
+            back.clear();
+            front.clear();
+            frontHead = 0;
+            backAggregate = Operator::template identity<T>();
+            size = 0;
+        }
+        back.insert(back.end(), values, values + count);
+        backAggregate = Operator::template apply<T>(backAggregate, reducer(values, count));
+        size += count;
+        if(size > window)
+        {
+            evict(size - window);
+        }
+    }
+    void push(T value) { push(&value, 1); }
+
+    T value() const
+    {
+        T frontAggregate = frontHead < front.size() ? front[frontHead] : Operator::template identity<T>();
+        return Operator::template apply<T>(frontAggregate, backAggregate);
+    }
+    size_t elements() const { return size; }
+
+private:
+    void evict(size_t count)
+    {
+        while(count > 0)
+        {
+            if(frontHead == front.size())
+            {
+                flip();
+            }
+            size_t step = std::min(count, front.size() - frontHead);
+            frontHead += step;
+            size -= step;
+            count -= step;
+        }
+    }
+    void flip()
+    {
+        front.resize(back.size());
+        T suffix = Operator::template identity<T>();
+        for(size_t i = back.size(); i-- > 0; )
+        {
+            suffix = Operator::template apply<T>(back[i], suffix);
+            front[i] = suffix;
+        }
+        frontHead = 0;
+        back.clear();
+        backAggregate = Operator::template identity<T>();
+    }
+
+    size_t window;
+    size_t size = 0;
+    std::vector<T> back;
+    T backAggregate = Operator::template identity<T>();
+    std::vector<T> front;
+    size_t frontHead = 0;
+    BlockReducer<T, Operator> reducer;
+};
+
+// Non-overlapping windows of a fixed length: whole windows inside an appended block are
+// reduced straight from the caller's memory, only the ragged ends are carried over.
+// Windows long enough for the external reducer are collected until complete, so the
+// reducer sees whole windows and not the small appended pieces.
+template<typename T, typename Operator = SumOperator>
+class TumblingWindow
+{
+public:
+    explicit TumblingWindow(size_t window) : window(std::max<size_t>(1, window)) {}
+
+    void setBlockReducer(const BlockReducer<T, Operator>& blockReducer) { reducer = blockReducer; }
+    const BlockReducer<T, Operator>& blockReducer() const { return reducer; }
+
+    // Calls emit once for every window completed by the appended elements
+    void push(const T* values, size_t count, const std::function<void(T)>& emit)
+    {
+        if(reducer.usesExternal(window))
+        {
+            pushBuffered(values, count, emit);
+            return;
+        }
+        if(filled > 0)
+        {
+            size_t take = std::min(count, window - filled);
+            partial = Operator::template apply<T>(partial, reducer(values, take));
+            filled += take;
+            values += take;
+            count -= take;
+            if(filled < window)
+            {
+                return;
+            }
+            emit(partial);
+            partial = Operator::template identity<T>();
+            filled = 0;
+        }
+        for(; count >= window; values += window, count -= window)
+        {
+            emit(reducer(values, window));
+        }
+        if(count > 0)
+        {
+            partial = reducer(values, count);
+            filled = count;
+        }
+    }
+
+private:
+    void pushBuffered(const T* values, size_t count, const std::function<void(T)>& emit)
+    {
+        while(count > 0)
+        {
+            if(pending.empty() && count >= window)
+            {
+                emit(reducer(values, window));
+                values += window;
+                count -= window;
+                continue;
+            }
+            size_t take = std::min(count, window - pending.size());
+            pending.insert(pending.end(), values, values + take);
+            values += take;
+            count -= take;
+            if(pending.size() == window)
+            {
+                emit(reducer(pending.data(), window));
+                pending.clear();
+            }
+        }
+    }
+
+    size_t window;
+    size_t filled = 0;
+    T partial = Operator::template identity<T>();
+    std::vector<T> pending; //open window of the buffered path
+    BlockReducer<T, Operator> reducer;
+};
+
+#endif //PARALLELREDUCTION_WINDOWREDUCTION_HPP